@@ -1,9 +1,23 @@
 """
 Code analysis endpoints
 """
+import asyncio
+import json
+import os
+from collections import OrderedDict
+from typing import Callable, Dict, List, Optional, Tuple, Union
 from fastapi import APIRouter, HTTPException
-from app.models.core import AnalysisRequest, AnalysisResult
-from app.parsers.cpp_analyzer import CppAnalyzer
+from fastapi.responses import JSONResponse, StreamingResponse
+from app.models.core import (
+    AnalysisJobStatus, AnalysisRequest, AnalysisResult, BatchAnalysisRequest, BatchAnalysisResult,
+    StyleGuideRulePlan, Violation, ViolationSeverity
+)
+from app.parsers.cpp_analyzer import ANALYSIS_STAGES, CppAnalyzer, streaming_analysis_bytes
+from app.parsers.incremental import AnalysisSnapshot
+from app.services.batch_service import BatchAnalysisService
+from app.services.job_queue import AnalysisJobQueue
+from app.services.metrics import collect_timings, timed
+from app.services.similarity_index import get_similarity_index, near_duplicate_reuse
 from app.api.files import uploaded_files
 from app.api.rag import rag_documents
 
@@ -11,27 +25,124 @@ router = APIRouter()
 
 # Initialize analyzer
 analyzer = CppAnalyzer()
+batch_service = BatchAnalysisService(analyzer)
+job_queue = AnalysisJobQueue()
 
+# Previous analysis per file_id, used to re-analyze new revisions incrementally.
+# Each holds the source, parse tree and rule results, so only the most
+# recently analyzed files are kept (least recently used first); an evicted
+# file's next revision is analyzed in full.
+analysis_snapshots: "OrderedDict[str, AnalysisSnapshot]" = OrderedDict()
+SNAPSHOT_RETENTION = max(1, int(os.getenv("ANALYSIS_SNAPSHOT_RETENTION", "200")))
 
-@router.post("/analyze", response_model=AnalysisResult)
-async def analyze_code(request: AnalysisRequest):
+
+def _keep_snapshot(file_id: str, snapshot: AnalysisSnapshot) -> None:
+    analysis_snapshots[file_id] = snapshot
+    analysis_snapshots.move_to_end(file_id)
+    while len(analysis_snapshots) > SNAPSHOT_RETENTION:
+        analysis_snapshots.popitem(last=False)
+
+
+def _near_duplicate_snapshot(file_id: str) -> Optional[Tuple[str, AnalysisSnapshot, float]]:
     """
-    Analyze uploaded C++ file for style violations
+    Snapshot of the most similar already-analyzed file, to analyze file_id as a revision of it
 
-    This endpoint will:
-    1. Retrieve the file from storage
-    2. Retrieve the style guide from RAG storage
-    3. Run basic C++ analysis (text-based heuristics)
-    4. Return violations with details
+    Reparsing edits a copy of the snapshot's tree, so the other file's
+    snapshot is shared as is.
+    """
+    for other_id, score in get_similarity_index().find_similar(file_id):
+        snapshot = analysis_snapshots.get(other_id)
+        if snapshot is not None:
+            return other_id, snapshot, score
+    return None
+
+
+def _load_file(file_id: str) -> Optional[Dict]:
+    """An upload with its content read, unless it is large enough to be streamed (None if unknown)"""
+    file_data = uploaded_files.get(file_id)
+    if file_data is not None and file_data.get("size", 0) <= streaming_analysis_bytes():
+        file_data["content"]  # Read the body now; the record keeps it
+    return file_data
+
+
+def _rule_plan(style_guide: Dict) -> Optional[StyleGuideRulePlan]:
+    """The rule plan stored with a style guide, if it has one"""
+    plan = style_guide.get("rule_plan")
+    return StyleGuideRulePlan.model_validate(plan) if plan else None
+
+
+async def _run_analysis(
+    file_id: str,
+    style_guide: Dict,
+    use_rag: bool,
+    progress: Optional[Callable[[str], None]] = None,
+    on_violations: Optional[Callable[[str, List[Violation]], None]] = None,
+    include_timings: bool = False
+) -> AnalysisResult:
+    """Analyze the current revision of an uploaded file and keep its snapshot"""
+    file_data = await asyncio.to_thread(_load_file, file_id)
+    if file_data is None:
+        # Deleted while a background job was waiting in the queue
+        raise ValueError(f"File not found: {file_id}")
+    if file_data.get("size", 0) > streaming_analysis_bytes():
+        # Large files are read line by line instead of being loaded; the older
+        # snapshot no longer matches this revision, so it cannot be diffed against
+        analysis_snapshots.pop(file_id, None)
+        with collect_timings() as timings, timed("total"):
+            result = await analyzer.analyze_lines(
+                file_data.lines(),
+                file_data.blob,
+                file_name=file_data["name"],
+                file_path=file_data["name"],
+                style_guide=style_guide["content"],
+                use_rag=use_rag,
+                rule_plan=_rule_plan(style_guide),
+                progress=progress,
+                on_violations=on_violations
+            )
+        if include_timings:
+            result.timings = dict(timings)
+        return result
+    previous = analysis_snapshots.get(file_id)
+    if previous is not None:
+        analysis_snapshots.move_to_end(file_id)
+    # A first analysis can start from a near-identical earlier submission
+    reused = None
+    if previous is None and near_duplicate_reuse():
+        reused = await asyncio.to_thread(_near_duplicate_snapshot, file_id)
+        if reused is not None:
+            previous = reused[1]
+    with collect_timings() as timings, timed("total"):
+        result, snapshot = await analyzer.analyze_revision(
+            file_content=file_data["content"],
+            file_name=file_data["name"],
+            file_path=file_data["name"],  # Use filename as path for MVP
+            style_guide=style_guide["content"],
+            use_rag=use_rag,
+            previous=previous,
+            rule_plan=_rule_plan(style_guide),
+            progress=progress,
+            on_violations=on_violations
+        )
+    if include_timings:
+        result.timings = dict(timings)
+    if reused is not None and result.status == "success" and not result.cached:
+        result.reused_from, result.similarity = reused[0], round(reused[2], 3)
+    if snapshot is not None:
+        _keep_snapshot(file_id, snapshot)
+    return result
+
+
+def _resolve_request(request: AnalysisRequest) -> Dict:
+    """
+    Validate the file and style guide of a request; returns the style guide entry
+
+    Reads the index and the guide's body, so handlers call it in a worker thread.
     """
     # Retrieve uploaded file
     if request.file_id not in uploaded_files:
         raise HTTPException(status_code=404, detail=f"File not found: {request.file_id}")
 
-    file_data = uploaded_files[request.file_id]
-    file_content = file_data["content"]
-    file_name = file_data["name"]
-
     # Retrieve style guide
     if not request.style_guide_id:
         raise HTTPException(status_code=400, detail="Style guide ID is required")
@@ -39,40 +150,188 @@ async def analyze_code(request: AnalysisRequest):
     if request.style_guide_id not in rag_documents:
         raise HTTPException(status_code=404, detail=f"Style guide not found: {request.style_guide_id}")
 
-    style_guide_data = rag_documents[request.style_guide_id]
-    style_guide_content = style_guide_data["content"]
+    style_guide = rag_documents[request.style_guide_id]
+    style_guide["content"]  # Read the body now; the record keeps it
+    return style_guide
+
+
+def _sse(event: str, data) -> str:
+    return f"event: {event}\ndata: {json.dumps(data)}\n\n"
+
+
+@router.post("/analyze", response_model=Union[AnalysisResult, AnalysisJobStatus])
+async def analyze_code(request: AnalysisRequest):
+    """
+    Analyze uploaded C++ file for style violations
+
+    This endpoint will:
+    1. Retrieve the file from storage
+    2. Retrieve the style guide from RAG storage
+    3. Run basic C++ analysis (text-based heuristics)
+    4. Return violations with details
+
+    If the file was analyzed before, only the lines changed since that
+    revision are re-checked and the other violations are carried forward.
+
+    With background=true the analysis is queued and its job status (with the
+    analysis_id for /status and /results) is returned immediately.
+    """
+    style_guide = await asyncio.to_thread(_resolve_request, request)
+
+    if request.background:
+        job = job_queue.submit(
+            request.file_id,
+            ANALYSIS_STAGES,
+            lambda progress: _run_analysis(
+                request.file_id, style_guide, request.use_rag, progress, include_timings=request.include_timings
+            )
+        )
+        return job.status
 
     # Run analysis
     try:
-        result = await analyzer.analyze_file(
-            file_content=file_content,
-            file_name=file_name,
-            file_path=file_name,  # Use filename as path for MVP
-            style_guide=style_guide_content,
-            use_rag=request.use_rag
+        return await _run_analysis(
+            request.file_id, style_guide, request.use_rag, include_timings=request.include_timings
         )
-        return result
     except Exception as e:
         raise HTTPException(status_code=500, detail=f"Analysis failed: {str(e)}")
 
 
-@router.get("/results/{analysis_id}")
-async def get_analysis_results(analysis_id: str):
+@router.post("/analyze/stream")
+async def analyze_code_stream(request: AnalysisRequest):
     """
-    Retrieve analysis results by ID
-    (Not implemented in MVP - analysis is synchronous)
+    Analyze a file and stream findings as Server-Sent Events
+
+    Events, in order:
+    - stage: {"stage": name} when each analysis stage starts
+    - violations: {"stage": name, "violations": [...], "violations_by_severity":
+      {...}, "violations_by_type": {...}} as findings arrive; rule-based checks
+      first, then LLM comment issues one by one. The counts cover everything
+      streamed so far (before deduplication)
+    - result: the final, deduplicated AnalysisResult
+    - error: {"detail": message} if the analysis failed
     """
-    raise HTTPException(status_code=501, detail="Not yet implemented - use synchronous /analyze endpoint")
+    style_guide = await asyncio.to_thread(_resolve_request, request)
+    queue: asyncio.Queue = asyncio.Queue()
+    by_severity = {severity.value: 0 for severity in ViolationSeverity}
+    by_type: Dict[str, int] = {}
 
+    def on_violations(stage: str, found: List[Violation]) -> None:
+        for v in found:
+            by_severity[v.severity.value] += 1
+            by_type[v.type] = by_type.get(v.type, 0) + 1
+        queue.put_nowait(_sse("violations", {
+            "stage": stage,
+            "violations": [v.model_dump(mode="json") for v in found],
+            "violations_by_severity": by_severity,
+            "violations_by_type": by_type
+        }))
 
-@router.get("/status/{analysis_id}")
-async def get_analysis_status(analysis_id: str):
+    task = asyncio.create_task(_run_analysis(
+        request.file_id,
+        style_guide,
+        request.use_rag,
+        progress=lambda stage: queue.put_nowait(_sse("stage", {"stage": stage})),
+        on_violations=on_violations,
+        include_timings=request.include_timings
+    ))
+    task.add_done_callback(lambda _: queue.put_nowait(None))
+
+    async def events():
+        try:
+            while True:
+                message = await queue.get()
+                if message is None:
+                    break
+                yield message
+            if task.exception() is not None:
+                yield _sse("error", {"detail": f"Analysis failed: {task.exception()}"})
+            else:
+                yield _sse("result", task.result().model_dump(mode="json"))
+        finally:
+            # Client went away; stop waiting on the LLM
+            if not task.done():
+                task.cancel()
+
+    return StreamingResponse(
+        events(),
+        media_type="text/event-stream",
+        headers={"Cache-Control": "no-cache", "X-Accel-Buffering": "no"}
+    )
+
+
+def _select_batch(request: BatchAnalysisRequest) -> Tuple[Dict[str, Dict], Dict]:
+    """The files and the style guide entry of a batch request (blocking index reads)"""
+    style_guide = rag_documents.get(request.style_guide_id)
+    if style_guide is None:
+        raise HTTPException(status_code=404, detail=f"Style guide not found: {request.style_guide_id}")
+    style_guide["content"]  # Read the body now; the record keeps it
+
+    selected = {}
+    missing = []
+    for fid in request.file_ids:
+        file_data = uploaded_files.get(fid)
+        if file_data is None:
+            missing.append(fid)
+        else:
+            selected[fid] = file_data
+    if missing:
+        raise HTTPException(status_code=404, detail=f"Files not found: {', '.join(missing)}")
+
+    if request.path_prefix:
+        prefix = request.path_prefix.replace("\\", "/")
+        for fid, file_data in uploaded_files.items():
+            path = (file_data.get("path") or file_data["name"]).replace("\\", "/")
+            if path.startswith(prefix):
+                selected.setdefault(fid, file_data)
+    return selected, style_guide
+
+
+@router.post("/analyze/batch", response_model=BatchAnalysisResult)
+async def analyze_batch(request: BatchAnalysisRequest):
+    """
+    Analyze a set of uploaded files against one style guide
+
+    Files are selected by ID and/or by path prefix (e.g. an assignment
+    folder). Algorithmic checks run in a worker pool and LLM checks with
+    bounded concurrency; one failing file does not fail the batch.
+    """
+    if not request.style_guide_id:
+        raise HTTPException(status_code=400, detail="Style guide ID is required")
+
+    selected, style_guide = await asyncio.to_thread(_select_batch, request)
+    if not selected:
+        raise HTTPException(status_code=400, detail="No files selected for analysis")
+
+    return await batch_service.analyze_files(
+        selected, style_guide["content"], request.use_rag, _rule_plan(style_guide)
+    )
+
+
+@router.get("/results/{analysis_id}", response_model=AnalysisResult)
+async def get_analysis_results(analysis_id: str):
     """
-    Check analysis progress status
-    (Not implemented in MVP - analysis is synchronous)
+    Retrieve the result of a background analysis
+
+    Returns 202 with the job status while the analysis is still running.
     """
-    return {
-        "analysis_id": analysis_id,
-        "status": "not_implemented",
-        "message": "Use synchronous /analyze endpoint for MVP"
-    }
+    job = await asyncio.to_thread(job_queue.get, analysis_id)
+    if job is None:
+        raise HTTPException(status_code=404, detail=f"Analysis not found: {analysis_id}")
+
+    if job.status.status in ("queued", "running"):
+        return JSONResponse(status_code=202, content=job.status.model_dump(mode="json"))
+
+    if job.result is None:
+        raise HTTPException(status_code=500, detail=f"Analysis failed: {job.status.error_message}")
+
+    return job.result
+
+
+@router.get("/status/{analysis_id}", response_model=AnalysisJobStatus)
+async def get_analysis_status(analysis_id: str):
+    """Check analysis progress (current stage and completed stages)"""
+    job = await asyncio.to_thread(job_queue.get, analysis_id)
+    if job is None:
+        raise HTTPException(status_code=404, detail=f"Analysis not found: {analysis_id}")
+    return job.status
@@ -2,106 +2,298 @@
 File upload and management endpoints
 """
 from fastapi import APIRouter, UploadFile, File, HTTPException, Form
-from typing import List, Optional
+from typing import Dict, List, Optional
+import asyncio
 import os
+import tarfile
 import uuid
+import zipfile
+from app.api.rag import rag_documents
+from app.models.core import BatchAnalysisRequest
+from app.services.archive_service import ARCHIVE_SUFFIXES, is_archive, iter_archive
+from app.services.file_store import get_file_store
+from app.services.similarity_index import get_similarity_index
 
 router = APIRouter()
 
-# Temporary file storage (in-memory for MVP, will be improved)
-uploaded_files = {}
+# Uploaded files, kept in the on-disk file store (bodies are read lazily)
+uploaded_files = get_file_store().collection("files")
 
 
-@router.post("/upload")
-async def upload_file(
-    file: UploadFile = File(...),
-    relative_path: Optional[str] = Form(None)
-):
-    """
-    Upload a single C++ file for analysis
+ALLOWED_EXTENSIONS = {".cpp", ".hpp", ".h"}
+MAX_FILE_SIZE = 10 * 1024 * 1024  # 10MB as per specs
 
-    Supports both individual file uploads and folder uploads with relative paths.
-    Supported extensions: .cpp, .hpp, .h
-    """
+
+async def _read_upload(file: UploadFile) -> bytes:
+    """Validate extension and size of an uploaded C++ file and return its bytes"""
     # Validate file extension
-    allowed_extensions = {".cpp", ".hpp", ".h"}
     file_ext = os.path.splitext(file.filename)[1].lower()
 
-    if file_ext not in allowed_extensions:
+    if file_ext not in ALLOWED_EXTENSIONS:
         raise HTTPException(
             status_code=400,
-            detail=f"Unsupported file type. Allowed: {', '.join(allowed_extensions)}"
+            detail=f"Unsupported file type. Allowed: {', '.join(ALLOWED_EXTENSIONS)}"
         )
 
     # Read file content
     content = await file.read()
 
-    # Check file size (max 10MB as per specs)
-    max_size = 10 * 1024 * 1024  # 10MB
-    if len(content) > max_size:
+    # Check file size
+    if len(content) > MAX_FILE_SIZE:
         raise HTTPException(
             status_code=400,
             detail="File size exceeds 10MB limit"
         )
 
+    return content
+
+
+def _store_file(file_name: str, display_path: str, content: bytes) -> Dict:
+    """Store a new upload and return its upload response"""
     # Generate unique file ID
     file_id = str(uuid.uuid4())
+    text = content.decode("utf-8")
 
-    # Use relative_path if provided, otherwise just use filename
-    display_path = relative_path if relative_path else file.filename
-
-    # Store file (in-memory for MVP)
+    # Store file (identical bodies share one blob)
     uploaded_files[file_id] = {
         "id": file_id,
-        "name": file.filename,
+        "name": file_name,
         "path": display_path,  # Full path with directory structure
-        "content": content.decode("utf-8"),
-        "size": len(content)
+        "content": text,
+        "size": len(content),
+        "revision": 1
     }
+    # Lets a near-identical later upload be analyzed as a revision of this one
+    get_similarity_index().add(file_id, text)
 
     return {
         "id": file_id,
         "file_id": file_id,  # Alias for compatibility
-        "file_name": file.filename,
-        "filename": file.filename,  # Alias for compatibility
+        "file_name": file_name,
+        "filename": file_name,  # Alias for compatibility
         "file_path": display_path,  # Path with directory structure
         "file_size": len(content),
         "status": "uploaded"
     }
 
 
+@router.post("/upload")
+async def upload_file(
+    file: UploadFile = File(...),
+    relative_path: Optional[str] = Form(None)
+):
+    """
+    Upload a single C++ file for analysis
+
+    Supports both individual file uploads and folder uploads with relative paths.
+    Supported extensions: .cpp, .hpp, .h
+    """
+    content = await _read_upload(file)
+
+    # Use relative_path if provided, otherwise just use filename
+    display_path = relative_path if relative_path else file.filename
+
+    return await asyncio.to_thread(_store_file, file.filename, display_path, content)
+
+
+def _extract_archive(file: UploadFile, path_prefix: Optional[str]) -> Dict:
+    """Store every C++ source of an uploaded archive (runs in a worker thread)"""
+    uploaded, skipped = [], []
+    prefix = path_prefix.strip("/\\") + "/" if path_prefix else ""
+    for entry in iter_archive(file.file, file.filename, ALLOWED_EXTENSIONS, MAX_FILE_SIZE):
+        if entry.content is None:
+            skipped.append({"path": entry.path, "reason": entry.skipped})
+            continue
+        try:
+            uploaded.append(_store_file(os.path.basename(entry.path), prefix + entry.path, entry.content))
+        except UnicodeDecodeError:
+            skipped.append({"path": entry.path, "reason": "not UTF-8 text"})
+    return {"files": uploaded, "skipped": skipped}
+
+
+@router.post("/upload/archive")
+async def upload_archive(
+    file: UploadFile = File(...),
+    path_prefix: Optional[str] = Form(None),
+    analyze: bool = Form(False),
+    style_guide_id: Optional[str] = Form(None),
+    use_rag: bool = Form(False)
+):
+    """
+    Upload a zip/tar/tar.gz archive of a submissions tree
+
+    Entries are extracted and stored one at a time, keeping their relative
+    paths (under path_prefix, if given); only .cpp, .hpp and .h files are
+    kept. With analyze=true the extracted files are batch-analyzed against
+    style_guide_id before the response is returned.
+    """
+    if not is_archive(file.filename):
+        raise HTTPException(
+            status_code=400,
+            detail=f"Unsupported archive type. Allowed: {', '.join(ARCHIVE_SUFFIXES)}"
+        )
+
+    # Imported here because the analysis module imports this one
+    from app.api.analysis import analyze_batch
+    if analyze:
+        if not style_guide_id:
+            raise HTTPException(status_code=400, detail="Style guide ID is required")
+        if not await asyncio.to_thread(rag_documents.__contains__, style_guide_id):
+            raise HTTPException(status_code=404, detail=f"Style guide not found: {style_guide_id}")
+
+    try:
+        # Decompression and file-store writes are blocking; keep them off the event loop
+        result = await asyncio.to_thread(_extract_archive, file, path_prefix)
+    except (zipfile.BadZipFile, tarfile.TarError) as e:
+        raise HTTPException(status_code=400, detail=f"Invalid archive: {e}")
+
+    result["analysis"] = None
+    if analyze and result["files"]:
+        result["analysis"] = await analyze_batch(BatchAnalysisRequest(
+            file_ids=[f["file_id"] for f in result["files"]],
+            style_guide_id=style_guide_id,
+            use_rag=use_rag
+        ))
+    return result
+
+
+# Index lookups and blob reads are blocking; the handlers below run these in a worker thread
+def _list_files() -> List[Dict]:
+    return [
+        {
+            "id": fid,
+            "file_id": fid,  # Alias for compatibility
+            "file_name": fdata["name"],
+            "filename": fdata["name"],  # Alias for compatibility
+            "file_path": fdata.get("path", fdata["name"]),  # Full path with directory
+            "file_size": fdata["size"]
+        }
+        for fid, fdata in uploaded_files.items()
+    ]
+
+
+def _file_paths(file_ids: List[str]) -> Dict[str, str]:
+    """Display path of each file that still exists"""
+    paths = {}
+    for fid in file_ids:
+        fdata = uploaded_files.get(fid)
+        if fdata is not None:
+            paths[fid] = fdata.get("path", fdata["name"])
+    return paths
+
+
+def _load_file(file_id: str) -> Optional[Dict]:
+    """An upload with its content read, or None"""
+    file_data = uploaded_files.get(file_id)
+    if file_data is None:
+        return None
+    return {**file_data, "content": file_data["content"]}
+
+
+def _store_revision(file_id: str, file_data: Dict, content: bytes) -> Dict:
+    file_data = {
+        **file_data,
+        "content": content.decode("utf-8"),
+        "size": len(content),
+        "revision": file_data.get("revision", 1) + 1
+    }
+    uploaded_files[file_id] = file_data
+    get_similarity_index().add(file_id, file_data["content"])
+    return file_data
+
+
+def _delete_file(file_id: str) -> bool:
+    try:
+        del uploaded_files[file_id]
+    except KeyError:
+        return False
+    get_similarity_index().remove(file_id)
+    return True
+
+
 @router.get("/list")
 async def list_files():
     """Get list of all uploaded files with directory structure"""
-    return {
-        "files": [
-            {
-                "id": fid,
-                "file_id": fid,  # Alias for compatibility
-                "file_name": fdata["name"],
-                "filename": fdata["name"],  # Alias for compatibility
-                "file_path": fdata.get("path", fdata["name"]),  # Full path with directory
-                "file_size": fdata["size"]
-            }
-            for fid, fdata in uploaded_files.items()
-        ]
-    }
+    return {"files": await asyncio.to_thread(_list_files)}
+
+
+@router.get("/clusters")
+async def list_clusters(threshold: Optional[float] = None, min_size: int = 2):
+    """
+    Groups of near-identical uploads (e.g. copies of the starter code, or of each other)
+
+    threshold is the estimated token similarity (0.0 - 1.0) that links two
+    files; it defaults to NEAR_DUPLICATE_THRESHOLD.
+    """
+    groups = await asyncio.to_thread(get_similarity_index().clusters, threshold, max(2, min_size))
+    paths = await asyncio.to_thread(_file_paths, [fid for members in groups for fid in members])
+    clusters = []
+    for members in groups:
+        files = [{"file_id": fid, "file_path": paths[fid]} for fid in members if fid in paths]
+        if len(files) >= max(2, min_size):
+            clusters.append({"size": len(files), "files": files})
+    return {"clusters": clusters}
+
+
+@router.get("/{file_id}/similar")
+async def similar_files(file_id: str, threshold: Optional[float] = None, limit: int = 10):
+    """Uploads most similar to a file, with their estimated similarity"""
+    if not await asyncio.to_thread(uploaded_files.__contains__, file_id):
+        raise HTTPException(status_code=404, detail="File not found")
+    matches = await asyncio.to_thread(get_similarity_index().find_similar, file_id, threshold, limit)
+    paths = await asyncio.to_thread(_file_paths, [fid for fid, _ in matches])
+    similar = [
+        {"file_id": fid, "file_path": paths[fid], "similarity": round(score, 3)}
+        for fid, score in matches if fid in paths
+    ]
+    return {"file_id": file_id, "similar": similar}
 
 
 @router.get("/{file_id}")
 async def get_file(file_id: str):
     """Get file content by ID"""
-    if file_id not in uploaded_files:
+    file_data = await asyncio.to_thread(_load_file, file_id)
+    if file_data is None:
         raise HTTPException(status_code=404, detail="File not found")
 
-    return uploaded_files[file_id]
+    return file_data
+
+
+@router.put("/{file_id}")
+async def upload_revision(file_id: str, file: UploadFile = File(...)):
+    """
+    Upload a new revision of an existing file
+
+    The file keeps its ID, so the next analysis can reuse the results of the
+    previous revision and only re-check the lines that changed.
+    """
+    file_data = await asyncio.to_thread(uploaded_files.get, file_id)
+    if file_data is None:
+        raise HTTPException(status_code=404, detail="File not found")
+
+    content = await _read_upload(file)
+    file_data = await asyncio.to_thread(_store_revision, file_id, file_data, content)
+
+    return {
+        "id": file_id,
+        "file_id": file_id,  # Alias for compatibility
+        "file_name": file_data["name"],
+        "filename": file_data["name"],  # Alias for compatibility
+        "file_path": file_data["path"],
+        "file_size": len(content),
+        "revision": file_data["revision"],
+        "status": "updated"
+    }
 
 
 @router.delete("/{file_id}")
 async def delete_file(file_id: str):
     """Delete uploaded file"""
-    if file_id not in uploaded_files:
+    if not await asyncio.to_thread(_delete_file, file_id):
         raise HTTPException(status_code=404, detail="File not found")
 
-    del uploaded_files[file_id]
+    # Drop the incremental analysis state kept for this file
+    from app.api.analysis import analysis_snapshots
+    analysis_snapshots.pop(file_id, None)
+
     return {"status": "deleted", "file_id": file_id}
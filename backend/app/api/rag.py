@@ -1,16 +1,62 @@
 """
 RAG system management endpoints
 """
+import asyncio
+import logging
+import uuid
+from collections import OrderedDict
+from datetime import datetime
+from typing import Dict, List
 from fastapi import APIRouter, UploadFile, File, HTTPException
-from app.services.rag_service import RAGService
+from app.models.core import IngestJobStatus
+from app.services.file_store import get_file_store
+from app.services.job_store import get_job_store
+from app.services.rag_service import get_rag_service
+from app.services.rule_context import RULE_CATEGORIES
+from app.services.style_guide_service import StyleGuideProcessor
+
+logger = logging.getLogger(__name__)
 
 router = APIRouter()
 
-# Initialize RAG service
-rag_service = RAGService()
+# Shared RAG service (the same instance the analyzer uses)
+rag_service = get_rag_service()
+style_processor = StyleGuideProcessor()
+
+# Document text and metadata, kept in the on-disk file store so they survive
+# restarts and are shared between server processes
+rag_documents = get_file_store().collection("rag_documents")
+
+# Bulk ingestions of this process by ingest_id, oldest first; only the most
+# recent are kept. Statuses are also written to the shared job store, so
+# any server process can report them.
+ingest_jobs: "OrderedDict[str, IngestJobStatus]" = OrderedDict()
+INGEST_JOB_RETENTION = 100
+INGEST_JOB_KIND = "ingest"
+_ingest_tasks: Dict[str, asyncio.Task] = {}
+
+
+def _save_ingest(job: IngestJobStatus) -> None:
+    get_job_store().put(INGEST_JOB_KIND, job.ingest_id, job.status, job)
+
+
+async def _store_document(doc_id: str, filename: str, doc_type: str, content_text: str) -> None:
+    """
+    Keep the text for analysis, with the style guide's rule plan compiled once here
 
-# Keep in-memory storage for backward compatibility and quick access
-rag_documents = {}
+    The plan also holds the guide's excerpts per rule category, searched in
+    this document's chunks only, so analyses graded against it never search.
+    """
+    plan = style_processor.parse_style_guide(content_text, filename).plan
+    plan.rule_contexts = await rag_service.rule_contexts_async(doc_id, RULE_CATEGORIES)
+    rag_documents[doc_id] = {
+        "id": doc_id,
+        "filename": filename,
+        "type": doc_type,
+        "content": content_text,
+        "rule_plan": plan.model_dump(),
+        "status": "stored"
+    }
 
 
 @router.post("/upload")
@@ -23,21 +69,15 @@ async def upload_rag_document(file: UploadFile = File(...), doc_type: str = "sty
     content = await file.read()
     content_text = content.decode("utf-8")
 
-    # Add to vector database
-    doc_id = rag_service.add_document(
+    # Add to vector database (embedding runs off the event loop)
+    doc_id = await rag_service.add_document_async(
         content=content_text,
         doc_type=doc_type,
         metadata={"filename": file.filename}
     )
 
-    # Also store in memory for quick access
-    rag_documents[doc_id] = {
-        "id": doc_id,
-        "filename": file.filename,
-        "type": doc_type,
-        "content": content_text,
-        "status": "stored"
-    }
+    # Also store the text for analysis
+    await _store_document(doc_id, file.filename, doc_type, content_text)
 
     return {
         "id": doc_id,
@@ -51,6 +91,89 @@ async def upload_rag_document(file: UploadFile = File(...), doc_type: str = "sty
     }
 
 
+async def _run_ingest(job: IngestJobStatus, documents: List[Dict]) -> None:
+    loop = asyncio.get_running_loop()
+
+    def record_progress(done: int, total: int) -> None:
+        # Runs on the event loop, like every other change to the job
+        if job.status != "running":
+            return
+        job.chunks_done, job.chunks_total = done, total
+        job.progress = done / max(total, 1)
+        job.updated_at = datetime.utcnow()
+        _save_ingest(job)
+
+    def progress(done: int, total: int) -> None:
+        # Called from the embedding thread after each batch
+        loop.call_soon_threadsafe(record_progress, done, total)
+
+    job.status = "running"
+    _save_ingest(job)
+    try:
+        doc_ids = await rag_service.add_documents_async(documents, progress)
+        for doc_id, doc in zip(doc_ids, documents):
+            await _store_document(doc_id, doc["metadata"]["filename"], doc["doc_type"], doc["content"])
+        job.doc_ids = doc_ids
+        job.status = "completed"
+        job.progress = 1.0
+    except Exception as e:
+        logger.error("RAG ingestion %s failed: %s", job.ingest_id, e)
+        job.status = "failed"
+        job.error_message = str(e)
+    finally:
+        job.updated_at = datetime.utcnow()
+        _save_ingest(job)
+        _ingest_tasks.pop(job.ingest_id, None)
+
+
+@router.post("/upload/bulk", response_model=IngestJobStatus)
+async def upload_rag_documents(files: List[UploadFile] = File(...), doc_type: str = "reference"):
+    """
+    Upload many documents (e.g. a course reference library) in one request
+
+    The documents are ingested in the background: chunks of all documents
+    are embedded in large batches and written to ChromaDB batch by batch.
+    Poll /ingest/{ingest_id} for progress.
+    """
+    documents = []
+    for file in files:
+        content = await file.read()
+        documents.append({
+            "content": content.decode("utf-8"),
+            "doc_type": doc_type,
+            "metadata": {"filename": file.filename}
+        })
+
+    job = IngestJobStatus(
+        ingest_id=str(uuid.uuid4()),
+        status="queued",
+        documents=[doc["metadata"]["filename"] for doc in documents]
+    )
+    ingest_jobs[job.ingest_id] = job
+    _save_ingest(job)
+    get_job_store().prune(INGEST_JOB_KIND, INGEST_JOB_RETENTION)
+    while len(ingest_jobs) > INGEST_JOB_RETENTION:
+        oldest = next(iter(ingest_jobs))
+        if oldest in _ingest_tasks:
+            break
+        del ingest_jobs[oldest]
+    _ingest_tasks[job.ingest_id] = asyncio.create_task(_run_ingest(job, documents))
+    return job
+
+
+@router.get("/ingest/{ingest_id}", response_model=IngestJobStatus)
+async def get_ingest_status(ingest_id: str):
+    """Check the progress of a bulk upload"""
+    job = ingest_jobs.get(ingest_id)
+    if job is None:
+        # Started by another server process
+        stored = get_job_store().get(INGEST_JOB_KIND, ingest_id)
+        if stored is None:
+            raise HTTPException(status_code=404, detail=f"Ingestion not found: {ingest_id}")
+        job = IngestJobStatus.model_validate_json(stored[0])
+    return job
+
+
 @router.get("/documents")
 async def list_rag_documents():
     """List all documents in RAG knowledge base"""
@@ -73,13 +196,14 @@ async def list_rag_documents():
 async def delete_rag_document(doc_id: str):
     """Remove document from RAG knowledge base"""
     # Delete from vector database
-    success = rag_service.delete_document(doc_id)
+    success = await rag_service.delete_document_async(doc_id)
 
-    # Also delete from memory
-    if doc_id in rag_documents:
+    # Also delete the stored text
+    stored = doc_id in rag_documents
+    if stored:
         del rag_documents[doc_id]
 
-    if not success and doc_id not in rag_documents:
+    if not success and not stored:
         raise HTTPException(status_code=404, detail="Document not found")
 
     return {"status": "deleted", "document_id": doc_id}
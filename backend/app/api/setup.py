@@ -3,7 +3,8 @@ System setup and configuration endpoints
 """
 from fastapi import APIRouter
 import os
-from app.services.ollama_service import OllamaService
+from app.services import warmup
+from app.services.ollama_service import get_ollama_service
 
 router = APIRouter()
 
@@ -16,13 +17,11 @@ async def check_system():
     ollama_host = os.getenv("OLLAMA_HOST", "http://localhost:11434")
     ollama_model = os.getenv("OLLAMA_MODEL", "codellama:7b")
 
-    # Check actual Ollama connectivity
-    ollama_service = OllamaService()
-    ollama_running = await ollama_service.check_connection()
-    model_available = False
-    
-    if ollama_running:
-        model_available = await ollama_service.check_model()
+    # Check actual Ollama connectivity on every pool host (also updates routing)
+    ollama_service = get_ollama_service()
+    hosts = await ollama_service.check_hosts()
+    ollama_running = any(h["running"] for h in hosts)
+    model_available = any(h["model_available"] for h in hosts)
 
     return {
         "ollama_configured": True,
@@ -30,8 +29,10 @@ async def check_system():
         "ollama_model": ollama_model,
         "ollama_running": ollama_running,
         "model_available": model_available,
+        "ollama_hosts": hosts,
         "status": "ready" if (ollama_running and model_available) else "not_ready",
-        "message": _get_status_message(ollama_running, model_available)
+        "message": _get_status_message(ollama_running, model_available),
+        "warm_state": warmup.current_state()
     }
 
 
@@ -53,7 +54,22 @@ async def get_configuration():
     return {
         "ollama_host": os.getenv("OLLAMA_HOST", "http://localhost:11434"),
         "ollama_model": os.getenv("OLLAMA_MODEL", "codellama:7b"),
+        "ollama_hosts": get_ollama_service().pool.status(),
         "max_file_size_mb": os.getenv("MAX_FILE_SIZE_MB", "10"),
         "rag_enabled": True,
-        "temperature": os.getenv("OLLAMA_TEMPERATURE", "0.3")
+        "temperature": os.getenv("OLLAMA_TEMPERATURE", "0.3"),
+        "warmup_on_startup": warmup.warmup_enabled()
     }
+
+
+@router.get("/warmup")
+async def get_warm_state():
+    """Whether the embedder and Ollama model are loaded"""
+    return warmup.current_state()
+
+
+@router.post("/warmup")
+async def trigger_warm_up():
+    """Start loading the embedder and Ollama model in the background"""
+    warmup.start_warm_up()
+    return warmup.current_state()
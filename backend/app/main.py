@@ -3,14 +3,25 @@ Main FastAPI application entry point for Code Style Grader
 """
 from fastapi import FastAPI
 from fastapi.middleware.cors import CORSMiddleware
+from fastapi.responses import PlainTextResponse
 from dotenv import load_dotenv
+import logging
 import os
 
 # Load environment variables
 load_dotenv()
 
+# Diagnostic output goes through the logging module; LOG_LEVEL=DEBUG shows
+# the per-file analysis trace, the default only reports problems
+logging.basicConfig(
+    level=os.getenv("LOG_LEVEL", "WARNING").upper(),
+    format="%(asctime)s %(levelname)s %(name)s: %(message)s"
+)
+
 # Import routers
 from app.api import files, analysis, setup, rag
+from app.services import warmup
+from app.services.metrics import metrics
 
 app = FastAPI(
     title="Code Style Grader API",
@@ -44,6 +55,23 @@ async def health_check():
         "ollama_configured": os.getenv("OLLAMA_HOST") is not None
     }
 
+@app.get("/metrics", response_class=PlainTextResponse)
+async def get_metrics():
+    """Per-stage and per-rule latency histograms in the Prometheus text format"""
+    return PlainTextResponse(metrics.render(), media_type="text/plain; version=0.0.4")
+
+@app.on_event("startup")
+async def start_warm_up():
+    """With WARMUP_ON_STARTUP=true, load the embedder and Ollama model before the first request needs them"""
+    if warmup.warmup_enabled():
+        warmup.start_warm_up()
+
+@app.on_event("shutdown")
+async def shutdown_workers():
+    """Stop the background job workers and batch analysis worker processes"""
+    await analysis.job_queue.shutdown()
+    analysis.batch_service.shutdown()
+
 # Register API routers
 app.include_router(files.router, prefix="/api/files", tags=["files"])
 app.include_router(analysis.router, prefix="/api/analysis", tags=["analysis"])
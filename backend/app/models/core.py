@@ -26,11 +26,19 @@ class StyleGuideRule(BaseModel):
     section: str
 
 
+class StyleGuideRulePlan(BaseModel):
+    """What a style guide changes about an analysis, compiled once when the guide is uploaded"""
+    check_magic_numbers: bool = False
+    # Top excerpts of the guide per rule category (app.services.rule_context), retrieved at upload
+    rule_contexts: Dict[str, List[str]] = Field(default_factory=dict)
+
+
 class StyleGuide(BaseModel):
     """Parsed style guide document"""
     name: str
     rules: List[StyleGuideRule]
     raw_content: str
+    plan: Optional[StyleGuideRulePlan] = None
 
 
 class Violation(BaseModel):
@@ -49,6 +57,8 @@ class AnalysisRequest(BaseModel):
     file_id: str
     style_guide_id: Optional[str] = None
     use_rag: bool = False
+    background: bool = False  # Queue the analysis and return an analysis_id immediately
+    include_timings: bool = False  # Attach per-stage timings (seconds) to the result
 
 
 class AnalysisResult(BaseModel):
@@ -62,3 +72,66 @@ class AnalysisResult(BaseModel):
     violations_by_type: Dict[str, int]
     status: str = "success"
     error_message: Optional[str] = None
+    incremental: bool = False  # True when results were derived from the previous revision
+    cached: bool = False  # True when served from the analysis result cache
+    reused_from: Optional[str] = None  # file_id of the near-duplicate whose analysis was reused
+    similarity: Optional[float] = None  # Estimated similarity to reused_from (0.0 - 1.0)
+    llm_skipped: Optional[str] = None  # Why the LLM comment check was not called, e.g. "no non-header comments"
+    streamed: bool = False  # True when a large file was analyzed line by line (no parse tree or LLM)
+    omitted_violations: Optional[Dict[str, int]] = None  # Per type, violations counted but not listed
+    guide_context: Optional[Dict[str, str]] = None  # Per violation type, the style guide excerpt for its rule
+    timings: Optional[Dict[str, float]] = None  # Seconds per stage, when requested
+
+
+class BatchAnalysisRequest(BaseModel):
+    """Request to analyze a set of uploaded files (e.g. one assignment)"""
+    file_ids: List[str] = Field(default_factory=list)
+    path_prefix: Optional[str] = None  # Also include every file whose path starts with this prefix
+    style_guide_id: Optional[str] = None
+    use_rag: bool = False
+
+
+class BatchAnalysisSummary(BaseModel):
+    """Aggregate statistics over a batch analysis"""
+    total_files: int
+    analyzed_files: int
+    failed_files: int
+    cached_files: int
+    reused_files: int = 0  # Analyzed incrementally from a near-duplicate in the batch
+    total_violations: int
+    violations_by_severity: Dict[str, int]
+    violations_by_type: Dict[str, int]
+
+
+class BatchAnalysisResult(BaseModel):
+    """Per-file results of a batch analysis, keyed by file_id"""
+    results: Dict[str, AnalysisResult]
+    summary: BatchAnalysisSummary
+
+
+class AnalysisJobStatus(BaseModel):
+    """Progress of a background analysis job"""
+    analysis_id: str
+    file_id: str
+    status: str  # queued, running, completed, failed
+    stage: Optional[str] = None  # Stage currently running (see ANALYSIS_STAGES)
+    stages: List[str] = Field(default_factory=list)
+    stages_completed: List[str] = Field(default_factory=list)
+    progress: float = 0.0  # Fraction of stages completed, 0.0 - 1.0
+    created_at: datetime = Field(default_factory=datetime.utcnow)
+    updated_at: datetime = Field(default_factory=datetime.utcnow)
+    error_message: Optional[str] = None
+
+
+class IngestJobStatus(BaseModel):
+    """Progress of a bulk RAG ingestion"""
+    ingest_id: str
+    status: str  # queued, running, completed, failed
+    documents: List[str] = Field(default_factory=list)  # filenames being ingested
+    doc_ids: List[str] = Field(default_factory=list)  # set once the documents are stored
+    chunks_total: int = 0
+    chunks_done: int = 0
+    progress: float = 0.0  # Fraction of chunks embedded and stored, 0.0 - 1.0
+    created_at: datetime = Field(default_factory=datetime.utcnow)
+    updated_at: datetime = Field(default_factory=datetime.utcnow)
+    error_message: Optional[str] = None
@@ -0,0 +1,189 @@
+"""
+Split a source file into function/class units for the LLM comment check
+
+Sending the whole numbered file in one prompt overflows the model's context
+on large files, and the output budget cuts the answer short. Instead the
+file is cut into units along the tree-sitter function and class boundaries,
+units without any comment are dropped, and the rest are packed into
+prompt-sized batches that keep the original line numbers.
+"""
+from dataclasses import dataclass
+from typing import List, Optional, Set
+from app.parsers.cpp_parser import ParsedFile, TreeSitterParser
+from app.parsers.rule_engine import COMMENT_PREFIXES, block_comment_lines
+
+# Rendered characters per batch; ~4000 chars of numbered code stays well
+# inside CodeLlama's default 2048-token window next to the instructions
+DEFAULT_BATCH_CHARS = 4000
+
+
+@dataclass
+class CodeUnit:
+    """A contiguous range of lines (1-based, inclusive)"""
+    start_line: int
+    end_line: int
+    kind: str = "code"  # function, class, struct or code (top-level lines between them)
+    name: str = ""
+
+
+def _render_line(number: int, text: str) -> str:
+    return f"{number:4d} | {text}"
+
+
+def _unit_chars(unit: CodeUnit, lines: List[str]) -> int:
+    return sum(len(_render_line(n, lines[n - 1])) + 1 for n in range(unit.start_line, unit.end_line + 1))
+
+
+def _is_comment_line(number: int, lines: List[str], block_lines: Set[int]) -> bool:
+    return number in block_lines or lines[number - 1].strip().startswith(COMMENT_PREFIXES)
+
+
+def _tree_units(parsed: Optional[ParsedFile]) -> List[CodeUnit]:
+    if parsed is None:
+        return []
+    parser = TreeSitterParser()
+    units = [CodeUnit(f['start_line'], f['end_line'], 'function', f['name'])
+             for f in parser.extract_functions(parsed)]
+    units.extend(CodeUnit(c['start_line'], c['end_line'], c['kind'], c['name'])
+                 for c in parser.extract_classes(parsed))
+    # Outer units first so nested ones can be looked up under their parent
+    units.sort(key=lambda u: (u.start_line, -u.end_line))
+    return units
+
+
+def _partition(start: int, end: int, spans: List[CodeUnit], lines: List[str], max_chars: int) -> List[CodeUnit]:
+    """Cover lines start..end with the top-level spans inside it plus the gaps between them"""
+    result: List[CodeUnit] = []
+    cursor = start
+    i = 0
+    while i < len(spans):
+        span = spans[i]
+        # Spans nested inside this one, in order
+        j = i + 1
+        while j < len(spans) and spans[j].end_line <= span.end_line:
+            j += 1
+        nested = spans[i + 1:j]
+
+        if span.start_line > cursor:
+            result.append(CodeUnit(cursor, span.start_line - 1))
+        if nested and _unit_chars(span, lines) > max_chars:
+            # Too big for one prompt (e.g. a large class): split along its members
+            result.extend(_partition(span.start_line, span.end_line, nested, lines, max_chars))
+        else:
+            result.append(span)
+        cursor = span.end_line + 1
+        i = j
+    if cursor <= end:
+        result.append(CodeUnit(cursor, end))
+    return result
+
+
+def _attach_leading_comments(units: List[CodeUnit], lines: List[str], block_lines: Set[int]) -> List[CodeUnit]:
+    """Move comment lines directly above a function/class (doc comments) into that unit"""
+    for index in range(1, len(units)):
+        unit, before = units[index], units[index - 1]
+        if unit.kind == "code" or before.kind != "code":
+            continue
+        start = unit.start_line
+        while start - 1 >= before.start_line and _is_comment_line(start - 1, lines, block_lines):
+            start -= 1
+        if start != unit.start_line:
+            unit.start_line = start
+            before.end_line = start - 1
+    return [u for u in units if u.start_line <= u.end_line]
+
+
+def split_units(
+    code: str,
+    parsed: Optional[ParsedFile] = None,
+    max_chars: int = DEFAULT_BATCH_CHARS
+) -> List[CodeUnit]:
+    """
+    Cut a file into units covering every line
+
+    With a parse tree, units follow function and class boundaries (large
+    classes are split into their members); without one the whole file is a
+    single unit and batch_units() cuts it into line windows.
+    """
+    lines = code.split('\n')
+    if not lines:
+        return []
+    block_lines = block_comment_lines(lines)
+    units = _partition(1, len(lines), _tree_units(parsed), lines, max_chars)
+    return _attach_leading_comments(units, lines, block_lines)
+
+
+def commented_units(code: str, units: List[CodeUnit]) -> List[CodeUnit]:
+    """Units that contain at least one comment (full-line or trailing)"""
+    lines = code.split('\n')
+    block_lines = block_comment_lines(lines)
+    found = []
+    for unit in units:
+        for n in range(unit.start_line, unit.end_line + 1):
+            text = lines[n - 1]
+            if n in block_lines or '//' in text or '/*' in text:
+                found.append(unit)
+                break
+    return found
+
+
+def fit_units(code: str, units: List[CodeUnit], max_chars: int = DEFAULT_BATCH_CHARS) -> List[CodeUnit]:
+    """Cut units larger than max_chars rendered characters into line windows"""
+    lines = code.split('\n')
+    fitted: List[CodeUnit] = []
+    for unit in units:
+        if _unit_chars(unit, lines) <= max_chars:
+            fitted.append(unit)
+            continue
+        start, chars = unit.start_line, 0
+        for n in range(unit.start_line, unit.end_line + 1):
+            width = len(_render_line(n, lines[n - 1])) + 1
+            if chars + width > max_chars and n > start:
+                fitted.append(CodeUnit(start, n - 1, unit.kind, unit.name))
+                start, chars = n, 0
+            chars += width
+        fitted.append(CodeUnit(start, unit.end_line, unit.kind, unit.name))
+    return fitted
+
+
+def batch_units(code: str, units: List[CodeUnit], max_chars: int = DEFAULT_BATCH_CHARS) -> List[List[CodeUnit]]:
+    """
+    Pack units, in order, into batches of at most max_chars rendered characters
+
+    A unit that is larger than a batch on its own is cut into line windows.
+    """
+    lines = code.split('\n')
+    batches: List[List[CodeUnit]] = []
+    current: List[CodeUnit] = []
+    size = 0
+    for unit in fit_units(code, units, max_chars):
+        chars = _unit_chars(unit, lines)
+        if current and size + chars > max_chars:
+            batches.append(current)
+            current, size = [], 0
+        current.append(unit)
+        size += chars
+    if current:
+        batches.append(current)
+    return batches
+
+
+def render_batch(code: str, batch: List[CodeUnit]) -> str:
+    """Numbered code for a batch, using the file's line numbers; skipped lines are shown as '...'"""
+    lines = code.split('\n')
+    out: List[str] = []
+    previous_end: Optional[int] = None
+    for unit in batch:
+        if previous_end is not None and unit.start_line != previous_end + 1:
+            out.append("     ...")
+        out.extend(_render_line(n, lines[n - 1]) for n in range(unit.start_line, unit.end_line + 1))
+        previous_end = unit.end_line
+    return '\n'.join(out)
+
+
+def batch_lines(batch: List[CodeUnit]) -> Set[int]:
+    """Line numbers covered by a batch"""
+    covered: Set[int] = set()
+    for unit in batch:
+        covered.update(range(unit.start_line, unit.end_line + 1))
+    return covered
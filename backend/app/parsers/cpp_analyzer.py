@@ -1,15 +1,133 @@
 """
 Main C++ code analyzer combining tree-sitter and LLM analysis
 """
-import re
-from typing import Callable, Dict, List, Optional, Tuple
-from app.models.core import ViolationSeverity, Violation, AnalysisResult  # updated import
-from app.parsers.cpp_parser import TreeSitterParser
-from app.services.ollama_service import OllamaService
-from app.services.rag_service import RAGService
+import asyncio
+import logging
+import os
+from typing import Callable, Dict, List, Optional, Set, Tuple
+from app.models.core import ViolationSeverity, Violation, AnalysisResult, StyleGuideRulePlan
+from app.parsers.code_units import (
+    CodeUnit,
+    batch_lines,
+    batch_units,
+    commented_units,
+    fit_units,
+    render_batch,
+    split_units,
+)
+from app.parsers.cpp_parser import ParsedFile, TreeSitterParser
+from app.parsers.incremental import (
+    AnalysisSnapshot,
+    LineDiff,
+    diff_lines,
+    mark_comment_state_changes,
+    plan_rules,
+    remap_violations,
+    touches_comments,
+)
+from app.parsers.llm_gate import (
+    SKIP_ALL_CACHED,
+    SKIP_COMMENTS_UNCHANGED,
+    SKIP_FILE_TOO_LARGE,
+    gate_units,
+    record_decision,
+)
+from app.parsers.rule_engine import EngineRun, LineRule, RuleEngine, block_comment_lines
+from app.parsers.rules import (
+    FileHeaderCommentRule,
+    IndentationRule,
+    LineLengthRule,
+    MagicNumberRule,
+    MemoryLeakRule,
+    MemoryLeakTreeRule,
+    NamingConventionRule,
+    NamingConventionTreeRule,
+    NoCommentsRule,
+    NullVsNullptrRule,
+    SingleLineIfRule,
+)
+from app.services.file_store import BlobLines
+from app.services.metrics import timed
+from app.services.ollama_service import get_ollama_service
+from app.services.rag_service import get_rag_service
+from app.services.result_cache import AnalysisResultCache
+from app.services.rule_context import guide_context
 from app.services.style_guide_service import StyleGuideProcessor
 from datetime import datetime
 
+logger = logging.getLogger(__name__)
+
+# Bump whenever rule behavior or result shape changes so cached results are not reused
+ANALYZER_VERSION = "7"
+
+# Stages reported to the progress callback of analyze_revision, in order
+ANALYSIS_STAGES = ["formatting", "semantic", "llm", "dedup"]
+
+
+def llm_batch_chars() -> int:
+    """Size of one LLM comment-check prompt in rendered code characters"""
+    return int(os.getenv("LLM_BATCH_CHARS", "4000"))
+
+
+def streaming_analysis_bytes() -> int:
+    """Files larger than this are analyzed line by line from the file store (CppAnalyzer.analyze_lines)"""
+    return int(os.getenv("STREAMING_ANALYSIS_BYTES", str(2 * 1024 * 1024)))
+
+
+def max_violations_per_type() -> int:
+    """Violations of one type a rule lists in a streamed analysis; the rest are only counted"""
+    return int(os.getenv("MAX_VIOLATIONS_PER_TYPE", "200"))
+
+
+def basic_rules() -> List[LineRule]:
+    """Rules behind the built-in formatting checks"""
+    return [
+        IndentationRule(),              # 1. Proper indentation (nesting levels)
+        LineLengthRule(200),            # 2. Extremely long lines (>200 chars)
+        SingleLineIfRule(),             # 3. Single-line if statements without braces
+        FileHeaderCommentRule(),        # 4. File header comment
+        NoCommentsRule(),               # 5. CRITICAL: NO comments (excluding header)
+    ]
+
+
+def semantic_rules(check_magic_numbers: bool = False, parsed: Optional[ParsedFile] = None) -> List[LineRule]:
+    """Rules behind the semantic checks; tree-based variants are used when a parse tree exists"""
+    if parsed is not None:
+        rules: List[LineRule] = [MemoryLeakTreeRule(), NamingConventionTreeRule()]
+    else:
+        rules = [MemoryLeakRule(), NamingConventionRule()]
+
+    # Only check magic numbers if style guide mentions it
+    if check_magic_numbers:
+        rules.append(MagicNumberRule())
+
+    rules.append(NullVsNullptrRule())
+    return rules
+
+
+def run_tier1_checks(
+    file_content: str,
+    check_magic_numbers: bool
+) -> Tuple[List[Violation], List[Violation], List[CodeUnit], EngineRun]:
+    """
+    Run all algorithmic checks for one file without any LLM/RAG services.
+
+    Module-level so it can be shipped to a process pool; each worker process
+    keeps its own tree-sitter parser singleton.
+
+    Returns:
+        (formatting violations, semantic violations, units with comments for the LLM check,
+         the engine run, from which an AnalysisSnapshot without parse tree can be built)
+    """
+    parsed = TreeSitterParser().parse_code(file_content)
+    basic = basic_rules()
+    semantic = semantic_rules(check_magic_numbers, parsed)
+    run = RuleEngine().run_lines(None, basic + semantic, parsed, source=file_content)
+    formatting = [v for rule in basic for v in run.results.get(rule.signature(), [])]
+    semantic_found = [v for rule in semantic for v in run.results.get(rule.signature(), [])]
+    units = commented_units(file_content, split_units(file_content, parsed, llm_batch_chars()))
+    return formatting, semantic_found, units, run
+
 
 class CppAnalyzer:
     """
@@ -23,9 +141,14 @@ class CppAnalyzer:
 
     def __init__(self):
         self.tree_sitter_parser = TreeSitterParser()
-        self.ollama_service = OllamaService()
-        self.rag_service = RAGService()
+        # Shared per process; the RAG embedder is only loaded when first used
+        self.ollama_service = get_ollama_service()
+        self.rag_service = get_rag_service()
         self.style_processor = StyleGuideProcessor()
+        self.rule_engine = RuleEngine()
+        self.result_cache = AnalysisResultCache()
+        # Compile the combined trigger pattern of the built-in rules up front
+        self.rule_engine.compile(basic_rules() + semantic_rules(check_magic_numbers=True))
 
     async def analyze_file(
         self,
@@ -48,109 +171,465 @@ class CppAnalyzer:
         Returns:
             AnalysisResult with all detected violations
         """
+        result, _ = await self.analyze_revision(file_content, file_name, file_path, style_guide, use_rag)
+        return result
+
+    async def analyze_revision(
+        self,
+        file_content: str,
+        file_name: str,
+        file_path: str,
+        style_guide: str,
+        use_rag: bool = True,
+        previous: Optional[AnalysisSnapshot] = None,
+        rule_plan: Optional[StyleGuideRulePlan] = None,
+        progress: Optional[Callable[[str], None]] = None,
+        on_violations: Optional[Callable[[str, List[Violation]], None]] = None
+    ) -> Tuple[AnalysisResult, Optional[AnalysisSnapshot]]:
+        """
+        Analyze a file, reusing the analysis of its previous revision when given.
+
+        With a previous snapshot the old parse tree is edited and re-parsed
+        incrementally, line-scope rules only re-visit the edited lines, file-scope
+        rules re-run only if something changed, and LLM findings are carried
+        forward unless a comment line was edited.
+
+        Identical content analyzed with the same style guide and flags is served
+        from the persistent result cache without running any checks.
+
+        If given, progress is called with each name in ANALYSIS_STAGES as that
+        stage starts, and on_violations(stage, violations) with findings as
+        soon as they are known (before deduplication). With on_violations the
+        LLM response is streamed and each comment issue is reported as it is
+        parsed.
+
+        Returns:
+            (AnalysisResult, snapshot to pass as `previous` for the next revision);
+            the snapshot is None on a cache hit or if the analysis failed
+        """
+        def stage(name: str) -> None:
+            if progress is not None:
+                progress(name)
+
+        def emit(name: str, found: List[Violation]) -> None:
+            if on_violations is not None and found:
+                on_violations(name, found)
+
         try:
-            print(f"\n{'='*60}")
-            print(f"Starting analysis for: {file_name}")
-            print(f"File size: {len(file_content)} characters")
-            print(f"{'='*60}\n")
+            logger.debug("Starting analysis for %s (%d characters)", file_name, len(file_content))
+
+            cache_key = self.result_cache.make_key(
+                file_content, style_guide, use_rag, ANALYZER_VERSION, self.ollama_service.comment_review_config()
+            )
+            cached = self.result_cache.get(cache_key)
+            if cached is not None:
+                logger.debug("Cache hit, reusing %d violations", cached.total_violations)
+                return cached.model_copy(update={
+                    "file_name": file_name,
+                    "file_path": file_path,
+                    "cached": True,
+                    "incremental": False
+                }), None
+
+            lines = file_content.split('\n')
+            diff: Optional[LineDiff] = None
+
+            # Parse once; every tree-based check shares this tree
+            with timed("parse"):
+                if previous is not None:
+                    diff = diff_lines(previous.content.split('\n'), lines)
+                    mark_comment_state_changes(diff, previous.block_comment_lines, block_comment_lines(lines))
+                    logger.debug("Incremental: %d of %d lines changed", len(diff.dirty_lines), len(lines))
+                    if previous.parsed is not None:
+                        parsed = self.tree_sitter_parser.reparse(previous.parsed, file_content, diff.hunks)
+                    else:
+                        parsed = self.tree_sitter_parser.parse_code(file_content)
+                else:
+                    parsed = self.tree_sitter_parser.parse_code(file_content)
+
+            # Style guides are compiled into a rule plan at upload
+            if rule_plan is None:
+                rule_plan = self.compile_rule_plan(style_guide)
+            check_magic_numbers = rule_plan.check_magic_numbers
+
+            # Steps 1 and 2 share one scan of the file
+            stage("formatting")
+            formatting_rules = basic_rules()
+            semantic_checks = semantic_rules(check_magic_numbers, parsed)
+            with timed("rules"):
+                rule_results, block_lines = self._run_rules(
+                    lines, formatting_rules + semantic_checks, parsed, previous, diff, file_content
+                )
 
             # Step 1: Formatting checks
-            print("Step 1: Running formatting checks...")
-            print("  - Proper indentation (nesting levels)")
-            print("  - Line length (<200 chars)")
-            print("  - Single-line if statements (missing braces)")
-            print("  - File header comment")
-            print("  - No comments check - CRITICAL (excluding header)")
-            violations = self._run_basic_checks(file_content, style_guide)
-            print(f"[OK] Found {len(violations)} formatting violations")
+            violations = self._collect(rule_results, formatting_rules)
+            emit("formatting", violations)
+            logger.debug("Found %d formatting violations", len(violations))
 
             # Step 2: Algorithmic semantic checks
-            print("\nStep 2: Running algorithmic semantic checks...")
-            print("  - Memory leaks (new/delete matching)")
-            print("  - Naming conventions (camelCase/PascalCase)")
-
-            # Check if style guide mentions magic numbers
-            check_magic_numbers = False
-            if style_guide:
-                style_guide_lower = style_guide.lower()
-                if 'magic number' in style_guide_lower or 'const' in style_guide_lower or 'named constant' in style_guide_lower:
-                    check_magic_numbers = True
-                    print("  - Magic numbers (hardcoded literals)")
-
-            print("  - NULL vs nullptr")
-            semantic_violations = self._run_semantic_checks(file_content, check_magic_numbers)
-            print(f"[OK] Found {len(semantic_violations)} semantic violations")
+            stage("semantic")
+            semantic_violations = self._collect(rule_results, semantic_checks)
+            emit("semantic", semantic_violations)
+            logger.debug("Found %d semantic violations", len(semantic_violations))
             violations.extend(semantic_violations)
 
             # Step 3: LLM comment quality check (simple task)
+            llm_violations: Optional[List[Violation]] = None
+            llm_failed = False
+            llm_skipped: Optional[str] = None
+            stage("llm")
             if use_rag:
-                print("\nStep 3: LLM comment quality analysis...")
-                print("  [WAIT] Checking if comments are descriptive...")
-                llm_result = await self.ollama_service.check_comment_quality(
-                    code=file_content
-                )
-
-                if llm_result.get("status") == "success" and llm_result.get("violations"):
-                    llm_violations = self._convert_llm_violations(llm_result["violations"])
-                    print(f"[OK] Found {len(llm_violations)} comment quality issues")
+                if (previous is not None and previous.llm_violations is not None
+                        and not touches_comments(diff, previous.content.split('\n'), lines,
+                                                 previous.block_comment_lines, block_lines)):
+                    llm_violations = remap_violations(previous.llm_violations, diff, diff.dirty_lines)
+                    llm_skipped = SKIP_COMMENTS_UNCHANGED
+                    record_decision(llm_skipped)
+                    emit("llm", llm_violations)
                     violations.extend(llm_violations)
+                    logger.debug("No comment lines changed, reusing %d comment quality issues", len(llm_violations))
                 else:
-                    print("[OK] Comments are adequately descriptive")
-            else:
-                print("\nStep 3: LLM disabled, skipping comment quality check")
+                    with timed("llm"):
+                        llm_result = await self.review_comments(
+                            file_content,
+                            parsed=parsed,
+                            on_violations=(lambda found: emit("llm", found)) if on_violations is not None else None
+                        )
+                    found = llm_result["violations"]
+                    llm_skipped = llm_result["skip_reason"]
+                    logger.debug(
+                        "Sent %d LLM batch(es), %d unit(s) from cache, skipped %d unit(s)%s",
+                        llm_result['batches'], llm_result['cached_units'], llm_result['skipped_units'],
+                        f" (LLM skipped: {llm_skipped})" if llm_skipped else ""
+                    )
+
+                    if llm_result["status"] == "success":
+                        llm_violations = found
+                    else:
+                        # Keep what the successful batches found, but neither cache
+                        # nor carry forward an incomplete LLM stage
+                        llm_failed = True
+                    logger.debug("Found %d comment quality issues", len(found))
+                    violations.extend(found)
 
             # Remove duplicate violations (same line and type)
-            print(f"\nStep 4: Deduplicating violations...")
-            violations = self._deduplicate_violations(violations)
-            print(f"[OK] Final violation count: {len(violations)}")
-            print(f"{'='*60}\n")
-
-            # Calculate statistics
-            violations_by_severity = self._count_by_severity(violations)
-            violations_by_type = self._count_by_type(violations)
-
-            return AnalysisResult(
-                file_name=file_name,
-                file_path=file_path,
-                timestamp=datetime.now(),
-                violations=violations,
-                total_violations=len(violations),
-                violations_by_severity=violations_by_severity,
-                violations_by_type=violations_by_type,
-                status="success"
+            stage("dedup")
+            with timed("dedup"):
+                result = self._build_result(file_name, file_path, violations, incremental=previous is not None,
+                                            llm_skipped=llm_skipped)
+            if use_rag:
+                self.attach_guide_context(result, rule_plan)
+            logger.debug("Final violation count: %d", result.total_violations)
+
+            snapshot = AnalysisSnapshot(
+                content=file_content,
+                parsed=parsed,
+                rule_results=rule_results,
+                block_comment_lines=block_lines,
+                llm_violations=llm_violations
             )
+            # Don't pin a result that is missing LLM findings because Ollama was down
+            if not llm_failed:
+                self.result_cache.put(cache_key, result)
+            return result, snapshot
         except Exception as e:
-            print(f"Error during analysis: {e}")
-            return AnalysisResult(
-                file_name=file_name,
-                file_path=file_path,
-                timestamp=datetime.now(),
-                violations=[],
-                total_violations=0,
-                violations_by_severity={},
-                violations_by_type={},
-                status="error",
-                error_message=str(e)
-            )
+            logger.exception("Error during analysis of %s", file_name)
+            return self._error_result(file_name, file_path, e), None
+
+    async def analyze_lines(
+        self,
+        lines: BlobLines,
+        file_hash: str,
+        file_name: str,
+        file_path: str,
+        style_guide: str,
+        use_rag: bool = True,
+        rule_plan: Optional[StyleGuideRulePlan] = None,
+        progress: Optional[Callable[[str], None]] = None,
+        on_violations: Optional[Callable[[str, List[Violation]], None]] = None
+    ) -> AnalysisResult:
+        """
+        Analyze a large stored file in memory that does not grow with its size.
+
+        The lines are read from the blob store and scanned one at a time, so
+        neither the text nor a list of its lines is ever held. Without the
+        whole text there is no parse tree (the line-based semantic rules run
+        instead), no native scan and no LLM comment check. Each rule lists at
+        most max_violations_per_type() violations of a type and only counts
+        the rest, which appear in the totals and in omitted_violations; the
+        snippets of the listed violations are read back from the file.
+
+        file_hash is the content_hash of the file (its blob digest), used for
+        the result cache. progress and on_violations are as for
+        analyze_revision. No snapshot is kept, so the next revision is
+        analyzed from scratch.
+        """
+        def stage(name: str) -> None:
+            if progress is not None:
+                progress(name)
+
+        def emit(name: str, found: List[Violation]) -> None:
+            if on_violations is not None and found:
+                on_violations(name, found)
 
-    def _get_rag_context(self, code: str, style_guide: str) -> Optional[str]:
-        """Retrieve relevant context from RAG system"""
         try:
-            # Create a query combining code snippet and style guide info
-            query = f"C++ code analysis style guide rules:\n{code[:500]}"
+            cache_key = self.result_cache.make_key_for_hash(
+                file_hash, style_guide, use_rag, ANALYZER_VERSION, self.ollama_service.comment_review_config()
+            )
+            cached = self.result_cache.get(cache_key)
+            if cached is not None:
+                return cached.model_copy(update={
+                    "file_name": file_name,
+                    "file_path": file_path,
+                    "cached": True,
+                    "incremental": False
+                })
+
+            if rule_plan is None:
+                rule_plan = self.compile_rule_plan(style_guide)
+            formatting_rules = basic_rules()
+            semantic_checks = semantic_rules(rule_plan.check_magic_numbers)
+            limit = max_violations_per_type()
+            for rule in formatting_rules + semantic_checks:
+                rule.max_per_type = limit
+                rule.keep_snippets = False
+
+            stage("formatting")
+            with timed("rules"):
+                # Reading the file is blocking I/O, so the scan runs off the event loop
+                run = await asyncio.to_thread(lambda: self.rule_engine.run_lines(
+                    lines, formatting_rules + semantic_checks, track_block_comments=False
+                ))
+            violations = self._collect(run.results, formatting_rules)
+            emit("formatting", violations)
+            stage("semantic")
+            semantic_violations = self._collect(run.results, semantic_checks)
+            emit("semantic", semantic_violations)
+            violations.extend(semantic_violations)
+
+            stage("llm")
+            llm_skipped = None
+            if use_rag:
+                llm_skipped = SKIP_FILE_TOO_LARGE
+                record_decision(llm_skipped)
+
+            stage("dedup")
+            with timed("dedup"):
+                result = self._build_result(file_name, file_path, violations, streamed=True,
+                                            llm_skipped=llm_skipped)
+                self._add_omitted(result, run.omitted)
+            if use_rag:
+                self.attach_guide_context(result, rule_plan)
+            wanted = set().union(*(rule.snippet_lines for rule in formatting_rules + semantic_checks))
+            with timed("snippets"):
+                texts = await asyncio.to_thread(lines.text, {line for line, _ in wanted})
+            for v in result.violations:
+                if (v.line_number, v.type) in wanted:
+                    v.code_snippet = texts.get(v.line_number, "").rstrip() or None
+            logger.debug("Streamed %d lines of %s: %d violations, %d listed",
+                         run.total_lines, file_name, result.total_violations, len(result.violations))
+
+            self.result_cache.put(cache_key, result)
+            return result
+        except Exception as e:
+            logger.exception("Error during streamed analysis of %s", file_name)
+            return self._error_result(file_name, file_path, e)
+
+    async def review_comments(
+        self,
+        file_content: str,
+        parsed: Optional[ParsedFile] = None,
+        units: Optional[List[CodeUnit]] = None,
+        on_violations: Optional[Callable[[List[Violation]], None]] = None
+    ) -> Dict:
+        """
+        LLM comment quality check over the function/class units that contain comments
 
-            # Search for relevant chunks
-            relevant_chunks = self.rag_service.search_relevant_context(query, top_k=3)
+        The LLM gate (app.parsers.llm_gate) first drops units whose only
+        comments are the file header; with nothing left the LLM is not
+        called. Units already judged (same normalized code, prompt version
+        and model) are answered from the LLM response cache. The rest are packed into
+        prompt-sized batches (LLM_BATCH_CHARS) that keep the file's line
+        numbers; the batches run concurrently, bounded by OllamaService's
+        request limit. Findings on lines outside a batch are dropped since
+        the model could not have seen them.
 
-            if relevant_chunks:
-                context = "\n\n---\n\n".join(relevant_chunks)
-                return f"Relevant style guide excerpts:\n\n{context}"
+        Args:
+            units: Units with comments, if already computed (e.g. by run_tier1_checks)
+            on_violations: Stream responses and report findings as they are parsed
 
-            return None
+        Returns:
+            {"violations", "status" ("success" or "partial"), "batches",
+             "skipped_units", "cached_units",
+             "skip_reason" (why no LLM request was made, else None)}
+        """
+        max_chars = llm_batch_chars()
+        skipped = 0
+        if units is None:
+            all_units = split_units(file_content, parsed, max_chars)
+            units = commented_units(file_content, all_units)
+            skipped = len(all_units) - len(units)
+        decision = gate_units(file_content, units)
+        if not decision.run:
+            record_decision(decision.skip_reason)
+            return {
+                "violations": [],
+                "status": "success",
+                "batches": 0,
+                "skipped_units": skipped + len(units),
+                "cached_units": 0,
+                "skip_reason": decision.skip_reason
+            }
+        skipped += len(units) - len(decision.units)
+        # Cache entries are per unit as sent, so oversized units are cut first
+        units = fit_units(file_content, decision.units, max_chars)
+
+        lines = file_content.split('\n')
+
+        def unit_text(unit: CodeUnit) -> str:
+            return '\n'.join(lines[unit.start_line - 1:unit.end_line])
+
+        # Answer repeated units (starter code, shared helpers) from the cache
+        found: List[Dict] = []
+        pending: List[CodeUnit] = []
+        for unit in units:
+            cached = self.ollama_service.cached_comment_review(unit_text(unit))
+            if cached is None:
+                pending.append(unit)
+                continue
+            found.extend({**v, "line_number": v["line_number"] + unit.start_line - 1} for v in cached)
+        if found and on_violations is not None:
+            on_violations(self._convert_llm_violations(found))
 
-        except Exception as e:
-            print(f"Error retrieving RAG context: {e}")
-            return None
+        batches = batch_units(file_content, pending, max_chars)
+
+        async def review(batch: List[CodeUnit]) -> Tuple[bool, List[Dict]]:
+            allowed = batch_lines(batch)
+            numbered = render_batch(file_content, batch)
+
+            def visible(found_here: List[Dict]) -> List[Dict]:
+                return [v for v in found_here if v["line_number"] in allowed]
+
+            if on_violations is not None:
+                llm_result = await self.ollama_service.check_comment_quality_stream(
+                    code=file_content,
+                    on_violation=lambda v: on_violations(self._convert_llm_violations(visible([v]))),
+                    numbered_code=numbered
+                )
+            else:
+                llm_result = await self.ollama_service.check_comment_quality(
+                    code=file_content,
+                    numbered_code=numbered
+                )
+            ok = llm_result.get("status") == "success"
+            batch_found = visible(llm_result.get("violations") or [])
+            if ok:
+                # Cache per unit (batches are only a transport detail) with
+                # line numbers relative to the unit
+                for unit in batch:
+                    self.ollama_service.store_comment_review(unit_text(unit), [
+                        {**v, "line_number": v["line_number"] - unit.start_line + 1}
+                        for v in batch_found
+                        if unit.start_line <= v["line_number"] <= unit.end_line
+                    ])
+            return ok, batch_found
+
+        skip_reason = SKIP_ALL_CACHED if not batches else None
+        record_decision(skip_reason)
+        outcomes = await asyncio.gather(*[review(batch) for batch in batches])
+        for _, batch_found in outcomes:
+            found.extend(batch_found)
+        violations = self._convert_llm_violations(found)
+        violations.sort(key=lambda v: v.line_number)
+        return {
+            "violations": violations,
+            "status": "success" if all(ok for ok, _ in outcomes) else "partial",
+            "batches": len(batches),
+            "skipped_units": skipped,
+            "cached_units": len(units) - len(pending),
+            "skip_reason": skip_reason
+        }
+
+    def _build_result(self, file_name: str, file_path: str, violations: List[Violation], **flags) -> AnalysisResult:
+        """Deduplicate violations and wrap them with statistics in an AnalysisResult"""
+        violations = self._deduplicate_violations(violations)
+        return AnalysisResult(
+            file_name=file_name,
+            file_path=file_path,
+            timestamp=datetime.now(),
+            violations=violations,
+            total_violations=len(violations),
+            violations_by_severity=self._count_by_severity(violations),
+            violations_by_type=self._count_by_type(violations),
+            status="success",
+            **flags
+        )
+
+    def _add_omitted(self, result: AnalysisResult, omitted: Dict[Tuple[str, str], int]) -> None:
+        """Add violations a capped run counted but did not list to the result's totals"""
+        if not omitted:
+            return
+        by_type: Dict[str, int] = {}
+        for (kind, severity), count in omitted.items():
+            by_type[kind] = by_type.get(kind, 0) + count
+            result.violations_by_type[kind] = result.violations_by_type.get(kind, 0) + count
+            result.violations_by_severity[severity] = result.violations_by_severity.get(severity, 0) + count
+            result.total_violations += count
+        result.omitted_violations = by_type
+
+    def _error_result(self, file_name: str, file_path: str, error: Exception) -> AnalysisResult:
+        return AnalysisResult(
+            file_name=file_name,
+            file_path=file_path,
+            timestamp=datetime.now(),
+            violations=[],
+            total_violations=0,
+            violations_by_severity={},
+            violations_by_type={},
+            status="error",
+            error_message=str(error)
+        )
+
+    def _run_rules(
+        self,
+        lines: List[str],
+        rules: List[LineRule],
+        parsed: Optional[ParsedFile],
+        previous: Optional[AnalysisSnapshot],
+        diff: Optional[LineDiff],
+        source: Optional[str] = None
+    ) -> Tuple[Dict[str, List[Violation]], Set[int]]:
+        """
+        Run rules through the engine, merging with carried-forward results on incremental runs.
+
+        Returns results keyed by rule signature and the lines the scan found
+        inside block comments.
+        """
+        if previous is None or diff is None:
+            run = self.rule_engine.run_lines(lines, rules, parsed, source)
+            return run.results, run.block_comment_lines
+
+        to_run, carried, rechecked = plan_rules(rules, previous, diff, len(lines))
+        run = self.rule_engine.run_lines(lines, to_run, parsed, source)
+        for sig, found in run.results.items():
+            if sig in rechecked:
+                found = [v for v in found if v.line_number in rechecked[sig]]
+            merged = carried.get(sig, []) + found
+            merged.sort(key=lambda v: v.line_number)
+            carried[sig] = merged
+        return carried, run.block_comment_lines
+
+    def _collect(self, results: Dict[str, List[Violation]], rules: List[LineRule]) -> List[Violation]:
+        """Violations for the given rules, in rule registration order"""
+        collected: List[Violation] = []
+        for rule in rules:
+            collected.extend(results.get(rule.signature(), []))
+        return collected
+
+    def attach_guide_context(self, result: AnalysisResult, rule_plan: Optional[StyleGuideRulePlan]) -> None:
+        """Give the result the guide's excerpt for each violation type found (dict lookups, no search)"""
+        if rule_plan is not None and rule_plan.rule_contexts:
+            result.guide_context = guide_context(rule_plan.rule_contexts, result.violations_by_type)
 
     def _convert_llm_violations(self, llm_violations: List[Dict]) -> List[Violation]:
         """Convert LLM violation dicts to Violation objects"""
@@ -168,7 +647,7 @@ class CppAnalyzer:
                     )
                 )
             except Exception as e:
-                print(f"Error converting violation: {e}")
+                logger.warning("Error converting violation: %s", e)
                 continue
         return violations
 
@@ -222,334 +701,16 @@ class CppAnalyzer:
         Run built-in algorithmic formatting checks.
         These checks always run regardless of uploaded style guide.
         """
-        violations: List[Violation] = []
-        lines = code.split('\n')
-
-        try:
-            # 1. Check for proper indentation (nesting levels)
-            violations.extend(self._check_proper_indentation(lines))
-        except Exception as e:
-            print(f"[ERROR] in _check_proper_indentation: {e}")
-
-        try:
-            # 2. Check for extremely long lines (>200 chars)
-            violations.extend(self._check_line_length(lines, 200))
-        except Exception as e:
-            print(f"[ERROR] in _check_line_length: {e}")
-
-        try:
-            # 3. Check for single-line if statements without braces
-            violations.extend(self._check_single_line_if_statements(lines))
-        except Exception as e:
-            print(f"[ERROR] in _check_single_line_if_statements: {e}")
-
-        try:
-            # 4. Check for file header comment
-            violations.extend(self._check_file_header_comment(lines))
-        except Exception as e:
-            print(f"[ERROR] in _check_file_header_comment: {e}")
-
-        try:
-            # 5. CRITICAL: Check if file has NO comments (excluding header)
-            violations.extend(self._check_no_comments(lines))
-        except Exception as e:
-            print(f"[ERROR] in _check_no_comments: {e}")
-
-        return violations
-
-    def _check_proper_indentation(self, lines: List[str]) -> List[Violation]:
-        """Check for proper indentation based on brace nesting levels"""
-        violations = []
-        uses_tabs = None
-        uses_spaces = None
-        indent_size = None
-
-        # First pass: determine if file uses tabs or spaces and indentation size
-        for line in lines:
-            if not line.strip() or len(line) == len(line.lstrip()):
-                continue
-
-            # Check what type of indentation is used
-            if line[0] == '\t':
-                if uses_spaces:
-                    # Mixing tabs and spaces
-                    violations.append(Violation(
-                        type="mixed_indentation",
-                        severity=ViolationSeverity.WARNING,
-                        line_number=1,
-                        description="File mixes tabs and spaces for indentation. Use one consistently.",
-                        rule_reference="Consistent Indentation"
-                    ))
-                    return violations
-                uses_tabs = True
-                indent_size = 1
-            elif line[0] == ' ':
-                if uses_tabs:
-                    # Mixing tabs and spaces
-                    violations.append(Violation(
-                        type="mixed_indentation",
-                        severity=ViolationSeverity.WARNING,
-                        line_number=1,
-                        description="File mixes tabs and spaces for indentation. Use one consistently.",
-                        rule_reference="Consistent Indentation"
-                    ))
-                    return violations
-                uses_spaces = True
-                if indent_size is None:
-                    # Use standard: 4 spaces = 1 tab = 1 level
-                    indent_size = 4
-
-        if uses_tabs is None and uses_spaces is None:
-            # No indented lines found
-            return violations
-
-        # Second pass: check that indentation levels match brace nesting
-        expected_level = 0
-        in_switch = False
-
-        for i, line in enumerate(lines, 1):
-            stripped = line.strip()
-
-            # Skip empty lines and preprocessor directives
-            if not stripped or stripped.startswith('#'):
-                continue
-
-            # Calculate current indentation level
-            if uses_tabs:
-                current_indent = len(line) - len(line.lstrip('\t'))
-            else:
-                leading_spaces = len(line) - len(line.lstrip(' '))
-                current_indent = leading_spaces // indent_size if indent_size > 0 else 0
-
-            # Track if we're in a switch statement
-            if 'switch' in stripped and '{' in stripped:
-                in_switch = True
-
-            # Check for closing braces (decrease expected level before checking)
-            if stripped.startswith('}'):
-                expected_level = max(0, expected_level - 1)
-                if in_switch:
-                    in_switch = False
-
-            # Check if indentation matches expected level
-            if current_indent != expected_level and not stripped.startswith('}'):
-                # Allow flexibility for:
-                # - Labels (anything ending with :)
-                # - Access specifiers
-                # - Case statements and their contents (allow expected_level OR expected_level + 1)
-                is_label = stripped.endswith(':') or stripped in ['public:', 'private:', 'protected:']
-                is_case_related = stripped.startswith('case ') or stripped.startswith('default')
-                is_inside_switch = in_switch and (current_indent == expected_level + 1 or is_case_related)
-
-                if not (is_label or is_inside_switch):
-                    violations.append(Violation(
-                        type="improper_indentation",
-                        severity=ViolationSeverity.WARNING,
-                        line_number=i,
-                        description=f"Indentation level {current_indent} does not match expected nesting level {expected_level}",
-                        rule_reference="Proper Indentation",
-                        code_snippet=line.rstrip()
-                    ))
-
-            # Check for opening braces (increase expected level after this line)
-            if '{' in stripped and not stripped.startswith('}'):
-                expected_level += stripped.count('{') - stripped.count('}')
-
-        return violations
-
-    def _check_line_length(self, lines: List[str], max_length: int) -> List[Violation]:
-        """Check for extremely long lines (>200 chars)"""
-        violations = []
-
-        for i, line in enumerate(lines, 1):
-            if len(line) > max_length:
-                violations.append(Violation(
-                    type="line_too_long",
-                    severity=ViolationSeverity.MINOR,
-                    line_number=i,
-                    description=f"Line is {len(line)} characters long (exceeds {max_length} character limit)",
-                    rule_reference="Maximum Line Length",
-                    code_snippet=line[:100] + "..." if len(line) > 100 else line
-                ))
-
-        return violations
-
-    def _check_consistent_braces(self, lines: List[str]) -> List[Violation]:
-        """Check that opening braces are placed consistently (same line OR next line, not mixed)"""
-        violations = []
-        same_line_count = 0
-        next_line_count = 0
-
-        for i, line in enumerate(lines, 1):
-            stripped = line.strip()
-
-            # Check for function/control structure followed by brace on same line
-            if re.search(r'(if|else|for|while|switch|class|struct)\s*\([^)]*\)\s*\{', stripped) or \
-               re.search(r'(class|struct)\s+\w+\s*\{', stripped):
-                same_line_count += 1
-
-            # Check for standalone opening brace (next line style)
-            if stripped == '{' and i > 1:
-                prev_line = lines[i-2].strip()
-                if re.search(r'(if|else|for|while|switch|class|struct)', prev_line):
-                    next_line_count += 1
-
-        # If mixing both styles significantly, report it
-        if same_line_count > 0 and next_line_count > 0:
-            violations.append(Violation(
-                type="inconsistent_brace_placement",
-                severity=ViolationSeverity.MINOR,
-                line_number=1,
-                description=f"File uses both same-line ({same_line_count}) and next-line ({next_line_count}) brace placement. Use one style consistently.",
-                rule_reference="Consistent Brace Placement"
-            ))
-
-        return violations
-
-    def _check_single_line_if_statements(self, lines: List[str]) -> List[Violation]:
-        """Check for single-line if statements without braces"""
-        violations = []
-
-        for i, line in enumerate(lines, 1):
-            stripped = line.strip()
-
-            # Match if/for/while at the start
-            keyword_match = re.match(r'^\s*(if|else\s+if|for|while)\s*\(', line)
-            if keyword_match:
-                # Find the matching closing parenthesis by counting parens
-                paren_count = 0
-                paren_start = keyword_match.end() - 1  # Position of opening '('
-                paren_end = -1
-
-                for pos in range(paren_start, len(line)):
-                    if line[pos] == '(':
-                        paren_count += 1
-                    elif line[pos] == ')':
-                        paren_count -= 1
-                        if paren_count == 0:
-                            paren_end = pos
-                            break
-
-                if paren_end == -1:
-                    # Couldn't find matching paren, skip
-                    continue
-
-                # Check what comes after the closing paren
-                remainder = line[paren_end + 1:].strip()
-
-                # If there's a brace on same line, it's OK
-                if remainder.startswith('{'):
-                    continue
-
-                # If there's code on the same line (one-liner), it's a violation
-                if remainder and not remainder.startswith('//'):
-                    violations.append(Violation(
-                        type="missing_braces",
-                        severity=ViolationSeverity.WARNING,
-                        line_number=i,
-                        description="Control structure should use braces even for single statements",
-                        rule_reference="Always Use Braces",
-                        code_snippet=stripped
-                    ))
-                    continue
-
-                # If next line doesn't start with '{', it's a violation
-                if i < len(lines):
-                    next_stripped = lines[i].strip()
-                    if next_stripped and not next_stripped.startswith('{') and not next_stripped.startswith('//'):
-                        violations.append(Violation(
-                            type="missing_braces",
-                            severity=ViolationSeverity.WARNING,
-                            line_number=i,
-                            description="Control structure should use braces even for single statements",
-                            rule_reference="Always Use Braces",
-                            code_snippet=stripped
-                        ))
-
-        return violations
-
-    def _check_file_header_comment(self, lines: List[str]) -> List[Violation]:
-        """Check for file header comment in first 10 lines"""
-        violations = []
-        has_header_comment = False
-
-        for i in range(min(10, len(lines))):
-            line = lines[i].strip()
-            if line.startswith('//') or line.startswith('/*') or line.startswith('*'):
-                has_header_comment = True
-                break
-
-        if not has_header_comment:
-            violations.append(Violation(
-                type="missing_file_header",
-                severity=ViolationSeverity.MINOR,
-                line_number=1,
-                description="File should have a header comment describing its purpose",
-                rule_reference="File Header Comment"
-            ))
-
-        return violations
-
-    def _check_comment_frequency(self, lines: List[str]) -> List[Violation]:
-        """Check that there's at least one comment every 20 lines of code"""
-        violations = []
-        code_lines = 0
-        last_comment_line = 0
-
-        for i, line in enumerate(lines, 1):
-            stripped = line.strip()
-
-            # Skip empty lines
-            if not stripped:
-                continue
-
-            # Check if this is a comment
-            if stripped.startswith('//') or stripped.startswith('/*') or stripped.startswith('*'):
-                last_comment_line = i
-                code_lines = 0  # Reset counter
-            else:
-                code_lines += 1
-
-                # If we have 20 lines of code without a comment, flag it
-                if code_lines >= 20:
-                    violations.append(Violation(
-                        type="insufficient_comments",
-                        severity=ViolationSeverity.MINOR,
-                        line_number=i,
-                        description=f"No comments found in the last 20 lines of code (since line {last_comment_line})",
-                        rule_reference="Comment Frequency"
-                    ))
-                    code_lines = 0  # Reset to avoid repeated violations
-
-        return violations
-
-    def _check_no_comments(self, lines: List[str]) -> List[Violation]:
-        """CRITICAL: Check if file has NO comments (excluding header comments)"""
-        violations = []
-        has_non_header_comment = False
-
-        # Skip first 10 lines (header comment area)
-        for i, line in enumerate(lines):
-            if i >= 10:  # Only check lines after the header
-                stripped = line.strip()
-                if stripped.startswith('//') or stripped.startswith('/*') or stripped.startswith('*'):
-                    has_non_header_comment = True
-                    break
-
-        if not has_non_header_comment:
-            violations.append(Violation(
-                type="no_comments",
-                severity=ViolationSeverity.CRITICAL,
-                line_number=11,
-                description="File contains NO comments beyond the header. Code must be documented for maintainability.",
-                rule_reference="Code Documentation"
-            ))
-
-        return violations
+        return self.rule_engine.run(code, basic_rules())
 
     # --- Algorithmic semantic checks (always run) ---
 
-    def _run_semantic_checks(self, code: str, check_magic_numbers: bool = False) -> List[Violation]:
+    def _run_semantic_checks(
+        self,
+        code: str,
+        check_magic_numbers: bool = False,
+        parsed: Optional[ParsedFile] = None
+    ) -> List[Violation]:
         """
         Run algorithmic semantic checks for memory leaks, naming, magic numbers, etc.
         These are deterministic and don't rely on LLM.
@@ -557,345 +718,18 @@ class CppAnalyzer:
         Args:
             code: Source code to analyze
             check_magic_numbers: Whether to check for magic numbers (based on style guide)
+            parsed: Shared parse tree; when present, naming and new/delete checks query it
         """
-        violations: List[Violation] = []
-        lines = code.split('\n')
+        return self.rule_engine.run(code, semantic_rules(check_magic_numbers, parsed), parsed)
 
-        try:
-            violations.extend(self._check_memory_leaks(lines))
-        except Exception as e:
-            print(f"[ERROR] in _check_memory_leaks: {e}")
+    # --- Style guide rule plans ---
 
-        try:
-            violations.extend(self._check_naming_conventions(lines))
-        except Exception as e:
-            print(f"[ERROR] in _check_naming_conventions: {e}")
-
-        # Only check magic numbers if style guide mentions it
-        if check_magic_numbers:
-            try:
-                violations.extend(self._check_magic_numbers(lines))
-            except Exception as e:
-                print(f"[ERROR] in _check_magic_numbers: {e}")
-
-        try:
-            violations.extend(self._check_null_vs_nullptr(lines))
-        except Exception as e:
-            print(f"[ERROR] in _check_null_vs_nullptr: {e}")
-
-        return violations
-
-    def _check_memory_leaks(self, lines: List[str]) -> List[Violation]:
-        """Detect simple memory leaks - new without corresponding delete"""
-        violations = []
-
-        # Track all new allocations and deletes in the code
-        new_patterns = []
-        delete_patterns = []
-
-        for i, line in enumerate(lines, 1):
-            stripped = line.strip()
-
-            # Skip comments
-            if stripped.startswith('//') or stripped.startswith('/*') or stripped.startswith('*'):
-                continue
-
-            # Find new allocations
-            if 'new ' in stripped or 'new[' in stripped:
-                # Extract variable name if possible
-                match = re.search(r'(\w+)\s*=\s*new\s+', stripped)
-                if match:
-                    var_name = match.group(1)
-                    is_array = 'new[]' in stripped or re.search(r'new\s+\w+\[', stripped)
-                    new_patterns.append({
-                        'line': i,
-                        'var': var_name,
-                        'is_array': is_array,
-                        'matched': False
-                    })
-
-            # Find delete statements
-            if 'delete ' in stripped or 'delete[]' in stripped:
-                match = re.search(r'delete\s*\[\s*\]?\s*(\w+)', stripped)
-                if not match:
-                    match = re.search(r'delete\s+(\w+)', stripped)
-                if match:
-                    var_name = match.group(1)
-                    is_array_delete = 'delete[]' in stripped or 'delete [' in stripped
-                    delete_patterns.append({
-                        'var': var_name,
-                        'is_array': is_array_delete
-                    })
-
-        # Match news with deletes
-        for new in new_patterns:
-            for delete in delete_patterns:
-                if new['var'] == delete['var']:
-                    new['matched'] = True
-                    # Check for delete/delete[] mismatch
-                    if new['is_array'] and not delete['is_array']:
-                        violations.append(Violation(
-                            type="wrong_delete_type",
-                            severity=ViolationSeverity.CRITICAL,
-                            line_number=new['line'],
-                            description=f"Array allocated with 'new[]' but deleted with 'delete' (should use 'delete[]')",
-                            rule_reference="Memory Management"
-                        ))
-                    elif not new['is_array'] and delete['is_array']:
-                        violations.append(Violation(
-                            type="wrong_delete_type",
-                            severity=ViolationSeverity.CRITICAL,
-                            line_number=new['line'],
-                            description=f"Single object allocated with 'new' but deleted with 'delete[]' (should use 'delete')",
-                            rule_reference="Memory Management"
-                        ))
-                    break
-
-        # Report unmatched news as memory leaks
-        for new in new_patterns:
-            if not new['matched']:
-                delete_type = "delete[]" if new['is_array'] else "delete"
-                violations.append(Violation(
-                    type="memory_leak",
-                    severity=ViolationSeverity.CRITICAL,
-                    line_number=new['line'],
-                    description=f"Memory allocated with 'new' but no corresponding '{delete_type}' found for variable '{new['var']}'",
-                    rule_reference="Memory Management"
-                ))
-
-        return violations
-
-    def _check_naming_conventions(self, lines: List[str]) -> List[Violation]:
-        """Check for camelCase functions and PascalCase classes"""
-        violations = []
-
-        for i, line in enumerate(lines, 1):
-            stripped = line.strip()
-
-            # Skip comments and preprocessor directives
-            if stripped.startswith('//') or stripped.startswith('/*') or stripped.startswith('*') or stripped.startswith('#'):
-                continue
-
-            # Check class names (should be PascalCase)
-            class_match = re.search(r'\bclass\s+([a-zA-Z_]\w*)', stripped)
-            if class_match:
-                class_name = class_match.group(1)
-                # PascalCase: starts with uppercase, no underscores
-                if not re.match(r'^[A-Z][a-zA-Z0-9]*$', class_name):
-                    violations.append(Violation(
-                        type="naming_convention",
-                        severity=ViolationSeverity.WARNING,
-                        line_number=i,
-                        description=f"Class '{class_name}' should use PascalCase (e.g., 'MyClass')",
-                        rule_reference="Naming Conventions",
-                        code_snippet=stripped
-                    ))
-
-            # Check function names (should be camelCase)
-            # Match: return_type function_name(
-            func_match = re.search(r'\b([a-z_]\w*)\s*\([^)]*\)\s*[{;]', stripped)
-            if func_match and 'if' not in stripped and 'for' not in stripped and 'while' not in stripped and 'switch' not in stripped:
-                func_name = func_match.group(1)
-                # Exclude constructors, main, common keywords
-                if func_name not in ['main', 'if', 'for', 'while', 'switch', 'return']:
-                    # camelCase: starts with lowercase, no underscores (except single letter at start)
-                    if '_' in func_name:
-                        violations.append(Violation(
-                            type="naming_convention",
-                            severity=ViolationSeverity.WARNING,
-                            line_number=i,
-                            description=f"Function '{func_name}' should use camelCase, not snake_case (e.g., 'myFunction')",
-                            rule_reference="Naming Conventions",
-                            code_snippet=stripped
-                        ))
-
-        return violations
-
-    def _check_magic_numbers(self, lines: List[str]) -> List[Violation]:
-        """Detect hardcoded numeric literals (magic numbers)"""
-        violations = []
-
-        for i, line in enumerate(lines, 1):
-            stripped = line.strip()
-
-            # Skip comments, preprocessor, and includes
-            if stripped.startswith('//') or stripped.startswith('/*') or stripped.startswith('*') or stripped.startswith('#'):
-                continue
-
-            # Find numeric literals that aren't 0, 1, -1
-            # Exclude: loop counters (i = 0, i < 10), array indices
-            numbers = re.findall(r'\b(\d+\.?\d*)\b', stripped)
-
-            for num in numbers:
-                # Allow 0, 1, and single-digit numbers in certain contexts
-                if num in ['0', '1']:
-                    continue
-
-                # Skip if in loop context
-                if re.search(r'(for|while)\s*\([^)]*' + num, stripped):
-                    continue
-
-                # Skip if it looks like array size or index
-                if re.search(r'\[' + num + r'\]', stripped):
-                    continue
-
-                # Flag as magic number
-                violations.append(Violation(
-                    type="magic_number",
-                    severity=ViolationSeverity.WARNING,
-                    line_number=i,
-                    description=f"Magic number '{num}' should be a named constant (e.g., 'const int MAX_SIZE = {num}')",
-                    rule_reference="Magic Numbers",
-                    code_snippet=stripped
-                ))
-                break  # Only report once per line
-
-        return violations
-
-    def _check_null_vs_nullptr(self, lines: List[str]) -> List[Violation]:
-        """Check for NULL usage instead of nullptr"""
-        violations = []
-
-        for i, line in enumerate(lines, 1):
-            stripped = line.strip()
-
-            # Skip comments
-            if stripped.startswith('//') or stripped.startswith('/*') or stripped.startswith('*'):
-                continue
-
-            # Check for NULL (but not in #define NULL or comments)
-            if re.search(r'\bNULL\b', stripped) and not stripped.startswith('#'):
-                violations.append(Violation(
-                    type="use_nullptr",
-                    severity=ViolationSeverity.WARNING,
-                    line_number=i,
-                    description="Use 'nullptr' instead of 'NULL' in modern C++",
-                    rule_reference="Modern C++ Practices",
-                    code_snippet=stripped
-                ))
-
-        return violations
-
-    def _parse_style_guide_rules(self, content: str):
-        """
-        Use StyleGuideProcessor; handle either StyleGuide object or list of rules.
-        """
-        sg = self.style_processor.parse_style_guide(content)
-        # Supports both returns: StyleGuide with .rules or direct list
-        rules = getattr(sg, "rules", sg)
-        return rules or []
-
-    def _rule_text(self, rule) -> str:
-        # Prefer description + name when available
-        name = getattr(rule, "rule_name", None) or getattr(rule, "name", None) or ""
-        desc = getattr(rule, "description", None) or getattr(rule, "text", None) or ""
-        return f"{name} {desc}".strip()
-
-    def _rule_reference(self, rule) -> Optional[str]:
-        # Use rule_name or a section/name-like attribute for reference
-        return getattr(rule, "rule_name", None) or getattr(rule, "name", None)
-
-    def _rule_severity(self, rule) -> ViolationSeverity:
-        sev = getattr(rule, "severity", None)
-        if isinstance(sev, ViolationSeverity):
-            return sev
-        if hasattr(sev, "name"):
-            name = sev.name.upper()
-        elif isinstance(sev, str):
-            name = sev.upper()
-        else:
-            name = "WARNING"
-        return {
-            "CRITICAL": ViolationSeverity.CRITICAL,
-            "WARNING": ViolationSeverity.WARNING,
-            "MINOR": ViolationSeverity.MINOR,
-        }.get(name, ViolationSeverity.WARNING)
-
-    # --- Rule matching by text ---
-
-    def _match_rule_to_check_text(self, text: str) -> Optional[Callable[[str, str], List[Tuple[int, Optional[int], str, str]]]]:
-        low = text.lower()
-
-        if "tab" in low and ("indent" in low or "tabs" in low or "no tab" in low):
-            return self._check_no_tabs
-
-        if "trailing whitespace" in low or "trailing spaces" in low:
-            return self._check_trailing_whitespace
-
-        if "line length" in low or "max line length" in low or "maximum line length" in low:
-            return self._check_line_length
-
-        if ("brace" in low or "braces" in low) and ("same line" in low or "k&r" in low or "opening brace" in low):
-            return self._check_opening_brace_same_line
-
-        if ("file header" in low or "header comment" in low or "file comment" in low):
-            return self._check_file_header_comment
-
-        return None
-
-    # --- Checks (return tuples of (line, col, message, violation_type)) ---
-
-    def _check_no_tabs(self, code: str, _rule_text: str):
-        results = []
-        for idx, line in enumerate(code.splitlines(), start=1):
-            if "\t" in line:
-                results.append((idx, line.find("\t") + 1, "Tabs found; use spaces for indentation", "indentation"))
-        return results
-
-    def _check_trailing_whitespace(self, code: str, _rule_text: str):
-        results = []
-        for idx, line in enumerate(code.splitlines(), start=1):
-            if re.search(r"[ \t]+$", line):
-                results.append((idx, None, "Trailing whitespace detected", "whitespace"))
-        return results
-
-    def _check_line_length(self, code: str, rule_text: str):
-        limit = self._extract_first_int(rule_text) or 100
-        results = []
-        for idx, line in enumerate(code.splitlines(), start=1):
-            if len(line) > limit and "http" not in line:
-                results.append((idx, limit + 1, f"Line exceeds maximum length of {limit} characters", "line_length"))
-        return results
-
-    def _check_opening_brace_same_line(self, code: str, _rule_text: str):
-        results = []
-        lines = code.splitlines()
-        control_re = re.compile(r"^\s*(if|for|while|switch|class|struct|namespace|template|try|catch|do|else|enum)\b.*[^;]$")
-        # fixed truncated regex
-        func_decl_re = re.compile(r"^\s*([A-Za-z_][A-Za-z0-9_:<>~\s*&]+)\s+([A-Za-z_][A-Za-z0-9_:<>~]*)\s*\([^;]*\)\s*(const\s*)?(\w*\s*)?$")
-        for i in range(len(lines) - 1):
-            curr = lines[i]
-            nxt = lines[i + 1]
-            if curr.strip().startswith("//") or curr.strip().startswith("/*") or curr.strip().startswith("#"):
-                continue
-            is_header = bool(control_re.match(curr)) or bool(func_decl_re.match(curr))
-            if is_header and "{" not in curr and re.match(r"^\s*{\s*$", nxt):
-                results.append((i + 2, 1, "Opening brace should be on the same line as the declaration/statement", "brace_style"))
-        return results
-
-    def _check_file_header_comment(self, code: str, _rule_text: str):
-        lines = code.splitlines()
-        i = 0
-        n = len(lines)
-        while i < n and lines[i].strip() == "":
-            i += 1
-        if i < n and (lines[i].lstrip().startswith("//") or lines[i].lstrip().startswith("/*")):
-            return []
-        if i < n:
-            return [(i + 1, 1, "Missing file header comment at top of file", "documentation")]
-        return []
+    def compile_rule_plan(self, style_guide: str) -> StyleGuideRulePlan:
+        """Compile a style guide's rule plan (normally done once at upload, see app.api.rag)"""
+        return self.style_processor.parse_style_guide(style_guide).plan
 
     # --- Helpers ---
 
-    def _extract_first_int(self, text: str) -> Optional[int]:
-        m = re.search(r"(\d+)", text)
-        if not m:
-            return None
-        try:
-            return int(m.group(1))
-        except ValueError:
-            return None
-
     def _line_snippet(self, code: str, line_no: int) -> Optional[str]:
         try:
             return code.splitlines()[line_no - 1]
@@ -1,21 +1,131 @@
 """
 C++ code parser using tree-sitter
 """
-from typing import List, Dict, Any, Optional
-# from tree_sitter import Language, Parser
+import bisect
+import logging
+import threading
+from typing import List, Dict, Any, Iterator, Optional, Tuple, Union
+
+logger = logging.getLogger(__name__)
+
+try:
+    from tree_sitter import Language, Parser
+    import tree_sitter_cpp
+except ImportError:  # tree-sitter is optional; checks fall back to line rules
+    Language = None
+    Parser = None
+    tree_sitter_cpp = None
+
+
+# Loading the grammar is the expensive part, so the language and parser are
+# created once per process and shared by every TreeSitterParser instance.
+_cpp_language = None
+_cpp_parser = None
+_load_failed = False
+_parser_lock = threading.Lock()
+
+
+def _load_cpp_language():
+    """Build the C++ Language object, tolerating the py-tree-sitter API changes"""
+    ptr = tree_sitter_cpp.language()
+    try:
+        return Language(ptr)
+    except TypeError:
+        # py-tree-sitter < 0.22 still requires a name argument
+        return Language(ptr, "cpp")
+
+
+def _get_cpp_parser():
+    """Return the process-wide parser, or None if tree-sitter is unavailable"""
+    global _cpp_language, _cpp_parser, _load_failed
+    if _cpp_parser is not None or _load_failed:
+        return _cpp_parser
+    with _parser_lock:
+        if _cpp_parser is None and not _load_failed:
+            if Parser is None or tree_sitter_cpp is None:
+                _load_failed = True
+                return None
+            try:
+                _cpp_language = _load_cpp_language()
+                try:
+                    parser = Parser(_cpp_language)
+                except TypeError:
+                    parser = Parser()
+                    parser.set_language(_cpp_language)
+                _cpp_parser = parser
+            except Exception as e:
+                logger.warning("tree-sitter C++ grammar unavailable: %s", e)
+                _load_failed = True
+    return _cpp_parser
+
+
+class ParsedFile:
+    """
+    A single parse of a source file, shared by every tree-based check
+
+    Nodes are indexed by type on first use so that checks can look up
+    e.g. all 'new_expression' nodes without walking the tree again.
+    """
+
+    def __init__(self, code: str, source: bytes, tree: Any):
+        self.code = code
+        self.source = source
+        self.tree = tree
+        self._lines: Optional[List[str]] = None
+        self._index: Optional[Dict[str, List[Any]]] = None
+
+    @property
+    def root(self) -> Any:
+        return self.tree.root_node
+
+    @property
+    def lines(self) -> List[str]:
+        if self._lines is None:
+            self._lines = self.code.split('\n')
+        return self._lines
+
+    def walk(self) -> Iterator[Any]:
+        """Pre-order traversal of every node in the tree"""
+        stack = [self.root]
+        while stack:
+            node = stack.pop()
+            yield node
+            stack.extend(reversed(node.children))
+
+    def nodes(self, *types: str) -> List[Any]:
+        """All nodes of the given types, in source order"""
+        if self._index is None:
+            index: Dict[str, List[Any]] = {}
+            for node in self.walk():
+                index.setdefault(node.type, []).append(node)
+            self._index = index
+        if len(types) == 1:
+            return self._index.get(types[0], [])
+        found = [n for t in types for n in self._index.get(t, [])]
+        found.sort(key=lambda n: n.start_byte)
+        return found
+
+    def text(self, node: Any) -> str:
+        return self.source[node.start_byte:node.end_byte].decode("utf-8", errors="replace")
+
+    def line_text(self, line_number: int) -> str:
+        """Stripped text of a 1-based line, for code snippets"""
+        if 1 <= line_number <= len(self.lines):
+            return self.lines[line_number - 1].strip()
+        return ""
 
 
 class TreeSitterParser:
     """Parse C++ code using tree-sitter for syntax analysis"""
 
     def __init__(self):
-        # TODO: Initialize tree-sitter with C++ language
-        # self.parser = Parser()
-        # self.cpp_language = Language('path/to/cpp.so', 'cpp')
-        # self.parser.set_language(self.cpp_language)
-        pass
+        self.parser = _get_cpp_parser()
 
-    def parse_code(self, code: str) -> Any:
+    @property
+    def available(self) -> bool:
+        return self.parser is not None
+
+    def parse_code(self, code: str) -> Optional[ParsedFile]:
         """
         Parse C++ code into syntax tree
 
@@ -23,14 +133,65 @@ class TreeSitterParser:
             code: C++ source code
 
         Returns:
-            Tree-sitter parse tree
+            ParsedFile wrapping the tree-sitter tree, or None if tree-sitter is unavailable
         """
-        # TODO: Implement parsing
-        # tree = self.parser.parse(bytes(code, "utf8"))
-        # return tree
-        return None
+        if self.parser is None:
+            return None
+        source = code.encode("utf-8")
+        with _parser_lock:
+            tree = self.parser.parse(source)
+        return ParsedFile(code, source, tree)
 
-    def find_syntax_issues(self, code: str) -> List[Dict[str, Any]]:
+    def reparse(self, previous: ParsedFile, code: str, hunks: List[Tuple[int, int, int, int]]) -> Optional[ParsedFile]:
+        """
+        Incrementally parse a new revision of a previously parsed file
+
+        Args:
+            previous: ParsedFile of the earlier revision (left unchanged; a copy of its tree is edited)
+            code: New source code
+            hunks: Changed line ranges as (old_start, old_end, new_start, new_end),
+                   0-based and end-exclusive, in ascending order (difflib opcodes)
+
+        Returns:
+            ParsedFile for the new revision
+        """
+        if self.parser is None or previous is None:
+            return self.parse_code(code)
+
+        source = code.encode("utf-8")
+        old_source = previous.source
+        old_offsets = _line_offsets(old_source)
+        new_offsets = _line_offsets(source)
+        # The previous tree stays valid for its own source: it belongs to a stored
+        # snapshot that a failed or concurrent analysis may still reparse from
+        tree = previous.tree.copy()
+
+        # Apply edits back to front so each edit's old coordinates are still
+        # valid in the partially edited tree
+        for old_start, old_end, new_start, new_end in reversed(hunks):
+            start_byte = min(old_offsets[old_start], len(old_source))
+            old_end_byte = min(old_offsets[old_end], len(old_source))
+            new_text = source[min(new_offsets[new_start], len(source)):min(new_offsets[new_end], len(source))]
+            start_point = _point_at(old_source, old_offsets, start_byte)
+            tree.edit(
+                start_byte=start_byte,
+                old_end_byte=old_end_byte,
+                new_end_byte=start_byte + len(new_text),
+                start_point=start_point,
+                old_end_point=_point_at(old_source, old_offsets, old_end_byte),
+                new_end_point=_advance(start_point, new_text),
+            )
+
+        with _parser_lock:
+            new_tree = self.parser.parse(source, tree)
+        return ParsedFile(code, source, new_tree)
+
+    def _ensure_parsed(self, code: Union[str, ParsedFile]) -> Optional[ParsedFile]:
+        if isinstance(code, ParsedFile):
+            return code
+        return self.parse_code(code)
+
+    def find_syntax_issues(self, code: Union[str, ParsedFile]) -> List[Dict[str, Any]]:
         """
         Find basic syntax issues using tree-sitter
 
@@ -39,32 +200,132 @@ class TreeSitterParser:
         - Unmatched braces
         - Invalid syntax
         """
-        # TODO: Implement syntax error detection
         issues = []
+        parsed = self._ensure_parsed(code)
+        if parsed is None or not parsed.root.has_error:
+            return issues
 
-        # Placeholder for basic checks
-        # tree = self.parse_code(code)
-        # if tree.root_node.has_error:
-        #     issues.append({
-        #         'type': 'syntax_error',
-        #         'message': 'Syntax error detected',
-        #         'line': 0
-        #     })
-
+        for node in parsed.walk():
+            if node.type == "ERROR":
+                issues.append({
+                    'type': 'syntax_error',
+                    'message': 'Syntax error detected',
+                    'line': node.start_point[0] + 1,
+                    'column': node.start_point[1] + 1
+                })
+            elif node.is_missing:
+                issues.append({
+                    'type': 'syntax_error',
+                    'message': f"Missing '{node.type}'",
+                    'line': node.start_point[0] + 1,
+                    'column': node.start_point[1] + 1
+                })
         return issues
 
-    def extract_functions(self, code: str) -> List[Dict[str, Any]]:
+    def extract_functions(self, code: Union[str, ParsedFile]) -> List[Dict[str, Any]]:
         """Extract all function definitions from code"""
-        # TODO: Implement function extraction
-        # Use tree-sitter query to find function_definition nodes
-        return []
+        parsed = self._ensure_parsed(code)
+        if parsed is None:
+            return []
+
+        functions = []
+        for node in parsed.nodes("function_definition"):
+            name_node = function_name_node(node)
+            functions.append({
+                'name': parsed.text(name_node) if name_node is not None else "",
+                'start_line': node.start_point[0] + 1,
+                'end_line': node.end_point[0] + 1,
+                'start_byte': node.start_byte,
+                'end_byte': node.end_byte,
+            })
+        return functions
 
-    def extract_classes(self, code: str) -> List[Dict[str, Any]]:
+    def extract_classes(self, code: Union[str, ParsedFile]) -> List[Dict[str, Any]]:
         """Extract all class definitions from code"""
-        # TODO: Implement class extraction
-        return []
+        parsed = self._ensure_parsed(code)
+        if parsed is None:
+            return []
+
+        classes = []
+        for node in parsed.nodes("class_specifier", "struct_specifier"):
+            # Skip forward declarations and elaborated type uses
+            if node.child_by_field_name("body") is None:
+                continue
+            name_node = node.child_by_field_name("name")
+            classes.append({
+                'name': parsed.text(name_node) if name_node is not None else "",
+                'kind': 'class' if node.type == "class_specifier" else 'struct',
+                'start_line': node.start_point[0] + 1,
+                'end_line': node.end_point[0] + 1,
+                'start_byte': node.start_byte,
+                'end_byte': node.end_byte,
+            })
+        return classes
 
     def get_node_at_position(self, tree: Any, line: int, column: int) -> Optional[Any]:
-        """Get syntax tree node at specific position"""
-        # TODO: Implement position-based node lookup
+        """Get syntax tree node at specific position (1-based line and column)"""
+        if tree is None:
+            return None
+        root = tree.root if isinstance(tree, ParsedFile) else tree.root_node
+        point = (max(line - 1, 0), max(column - 1, 0))
+        return root.descendant_for_point_range(point, point)
+
+
+# --- Tree helpers shared by the tree-based checks ---
+
+def _line_offsets(source: bytes) -> List[int]:
+    """Byte offset of the start of each line, plus one entry past the end"""
+    offsets = [0]
+    pos = source.find(b'\n')
+    while pos != -1:
+        offsets.append(pos + 1)
+        pos = source.find(b'\n', pos + 1)
+    offsets.append(len(source) + 1)
+    return offsets
+
+
+def _point_at(source: bytes, offsets: List[int], byte: int) -> Tuple[int, int]:
+    """(row, column) of a byte offset, given the offsets from _line_offsets"""
+    row = bisect.bisect_right(offsets, byte) - 1
+    return (row, byte - offsets[row])
+
+
+def _advance(point: Tuple[int, int], text: bytes) -> Tuple[int, int]:
+    """Point reached after inserting text at point"""
+    newlines = text.count(b'\n')
+    if newlines == 0:
+        return (point[0], point[1] + len(text))
+    return (point[0] + newlines, len(text) - text.rfind(b'\n') - 1)
+
+
+def function_declarator(node: Any) -> Optional[Any]:
+    """Follow nested declarators (pointer, reference, ...) down to the function_declarator"""
+    declarator = node.child_by_field_name("declarator")
+    while declarator is not None and declarator.type != "function_declarator":
+        declarator = declarator.child_by_field_name("declarator")
+    return declarator
+
+
+def function_name_node(node: Any) -> Optional[Any]:
+    """Name node of a function definition/declaration, unqualified (Foo::bar -> bar)"""
+    declarator = function_declarator(node)
+    if declarator is None:
         return None
+    name = declarator.child_by_field_name("declarator")
+    while name is not None and name.type == "qualified_identifier":
+        name = name.child_by_field_name("name")
+    return name
+
+
+def last_identifier(node: Any) -> Optional[Any]:
+    """Right-most identifier naming the target of an expression (this->data -> data, *p -> p, arr[i] -> arr)"""
+    if node.type in ("identifier", "field_identifier"):
+        return node
+    if node.type == "subscript_expression":
+        argument = node.child_by_field_name("argument")
+        return last_identifier(argument) if argument is not None else None
+    for child in reversed(node.children):
+        found = last_identifier(child)
+        if found is not None:
+            return found
+    return None
@@ -0,0 +1,147 @@
+"""
+Incremental re-analysis support
+
+Keeps what is needed from the previous analysis of a file (source, parse
+tree, per-rule violations) so that a new revision only re-runs the rules
+covering the lines that changed. Unchanged violations are carried forward
+with their line numbers remapped to the new revision.
+"""
+import difflib
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional, Set, Tuple
+from app.models.core import Violation
+from app.parsers.cpp_parser import ParsedFile
+from app.parsers.llm_gate import has_comment
+from app.parsers.rule_engine import LineRule
+
+
+@dataclass
+class AnalysisSnapshot:
+    """State kept between revisions of the same file"""
+    content: str
+    parsed: Optional[ParsedFile]
+    rule_results: Dict[str, List[Violation]]   # keyed by LineRule.signature()
+    block_comment_lines: Set[int]
+    llm_violations: Optional[List[Violation]] = None  # None when the LLM stage did not run
+
+
+@dataclass
+class LineDiff:
+    """Line-level difference between two revisions"""
+    hunks: List[Tuple[int, int, int, int]]            # difflib opcodes (0-based, end-exclusive)
+    line_map: Dict[int, int] = field(default_factory=dict)  # old line -> new line (1-based), unchanged lines only
+    dirty_lines: Set[int] = field(default_factory=set)      # new lines (1-based) that were edited or inserted
+    removed_lines: Set[int] = field(default_factory=set)    # old lines (1-based) that were edited or deleted
+
+    @property
+    def changed(self) -> bool:
+        return bool(self.hunks)
+
+
+def diff_lines(old_lines: List[str], new_lines: List[str]) -> LineDiff:
+    """Compute changed hunks and the unchanged-line mapping between two revisions"""
+    matcher = difflib.SequenceMatcher(a=old_lines, b=new_lines, autojunk=False)
+    diff = LineDiff(hunks=[])
+    for tag, i1, i2, j1, j2 in matcher.get_opcodes():
+        if tag == 'equal':
+            for offset in range(i2 - i1):
+                diff.line_map[i1 + offset + 1] = j1 + offset + 1
+            continue
+        diff.hunks.append((i1, i2, j1, j2))
+        diff.dirty_lines.update(range(j1 + 1, j2 + 1))
+        # The lines on each side of the hunk now have new neighbours (a pure
+        # deletion has no new lines of its own)
+        diff.dirty_lines.update(n for n in (j1, j2 + 1) if 1 <= n <= len(new_lines))
+        diff.removed_lines.update(range(i1 + 1, i2 + 1))
+    return diff
+
+
+def mark_comment_state_changes(diff: LineDiff, old_block_lines: Set[int], new_block_lines: Set[int]) -> None:
+    """
+    Treat unchanged lines whose block-comment state flipped as dirty
+
+    Opening or closing a /* */ comment changes how every following line is
+    classified even though their text is identical.
+    """
+    for old_line, new_line in diff.line_map.items():
+        if (old_line in old_block_lines) != (new_line in new_block_lines):
+            diff.dirty_lines.add(new_line)
+
+
+def expand(lines: Set[int], radius: int, total_lines: int) -> Set[int]:
+    """Grow a set of line numbers by `radius` lines in each direction"""
+    if radius <= 0:
+        return set(lines)
+    grown = set()
+    for line in lines:
+        grown.update(range(max(1, line - radius), min(total_lines, line + radius) + 1))
+    return grown
+
+
+def remap_violations(violations: List[Violation], diff: LineDiff, drop_lines: Set[int]) -> List[Violation]:
+    """
+    Carry violations forward to the new revision
+
+    Violations on edited/deleted lines, or that land on `drop_lines` in the
+    new revision, are dropped because the rule has re-checked those lines.
+    """
+    carried = []
+    for v in violations:
+        new_line = diff.line_map.get(v.line_number)
+        if new_line is None or new_line in drop_lines:
+            continue
+        carried.append(v if new_line == v.line_number else v.model_copy(update={"line_number": new_line}))
+    return carried
+
+
+def plan_rules(
+    rules: List[LineRule],
+    previous: AnalysisSnapshot,
+    diff: LineDiff,
+    total_lines: int
+) -> Tuple[List[LineRule], Dict[str, List[Violation]], Dict[str, Set[int]]]:
+    """
+    Decide which rules must run for a new revision
+
+    Returns the rules to hand to the RuleEngine (line-scope rules restricted
+    to the lines around the edits), the violations carried forward from the
+    previous revision, keyed by rule signature, to merge with their output,
+    and per line-scope rule the lines whose violations come from the new run
+    (its output elsewhere repeats carried violations and is discarded).
+    """
+    to_run: List[LineRule] = []
+    carried: Dict[str, List[Violation]] = {}
+    rechecked: Dict[str, Set[int]] = {}
+    for rule in rules:
+        sig = rule.signature()
+        earlier = previous.rule_results.get(sig)
+        if earlier is None:
+            # New rule or changed configuration (e.g. a different style guide)
+            to_run.append(rule)
+            continue
+        if not diff.changed and not diff.dirty_lines:
+            carried[sig] = list(earlier)
+            continue
+        if rule.scope == "line":
+            # A line may report on (or read) up to `context` neighbours, so
+            # results near the edits are replaced, re-visiting a slightly wider
+            # window to find every report that lands in it
+            drop = expand(diff.dirty_lines, rule.context, total_lines)
+            rule.only_lines = expand(diff.dirty_lines, 2 * rule.context, total_lines)
+            carried[sig] = remap_violations(earlier, diff, drop)
+            rechecked[sig] = drop
+        to_run.append(rule)
+    return to_run, carried, rechecked
+
+
+def touches_comments(diff: LineDiff, old_lines: List[str], new_lines: List[str],
+                     old_block_lines: Set[int], new_block_lines: Set[int]) -> bool:
+    """Whether any edited line (old or new side) has a comment, by the LLM gate's test"""
+    for n in diff.removed_lines:
+        if has_comment(old_lines[n - 1], n, old_block_lines):
+            return True
+    for _, _, j1, j2 in diff.hunks:
+        for n in range(j1 + 1, j2 + 1):
+            if has_comment(new_lines[n - 1], n, new_block_lines):
+                return True
+    return False
@@ -0,0 +1,75 @@
+"""
+Decide, from the cheap Tier 1 view of a file, whether the LLM comment check can add anything
+
+The comment check only judges existing comments, so a file with none (or
+whose only comments are its header block) cannot get LLM findings; sending
+it would cost seconds per file for nothing. The gate drops those units and
+records why the LLM stage was skipped, so the decision shows up in the
+result (AnalysisResult.llm_skipped) and in /metrics.
+"""
+from dataclasses import dataclass
+from typing import List, Optional, Set
+from app.parsers.code_units import CodeUnit
+from app.parsers.rule_engine import COMMENT_PREFIXES, block_comment_lines
+from app.services.metrics import metrics
+
+metrics.describe("grader_llm_gate_total", "LLM comment check decisions per file")
+
+SKIP_NO_COMMENTS = "no comments"
+SKIP_HEADER_ONLY = "no non-header comments"
+SKIP_ALL_CACHED = "all commented units already reviewed"
+SKIP_COMMENTS_UNCHANGED = "no comment lines changed"
+SKIP_FILE_TOO_LARGE = "file too large for LLM review"
+
+
+@dataclass
+class LLMGateDecision:
+    units: List[CodeUnit]  # units the LLM still has to see
+    skip_reason: Optional[str] = None
+
+    @property
+    def run(self) -> bool:
+        return self.skip_reason is None
+
+
+def file_header_lines(lines: List[str], block_lines: Set[int]) -> Set[int]:
+    """Comment lines of the leading block of comments and blank lines, before the first code line"""
+    header: Set[int] = set()
+    for number, text in enumerate(lines, 1):
+        stripped = text.strip()
+        if number in block_lines or stripped.startswith(COMMENT_PREFIXES):
+            header.add(number)
+        elif stripped:
+            break
+    return header
+
+
+def has_comment(text: str, number: int, block_lines: Set[int]) -> bool:
+    # Same test as code_units.commented_units: full-line, block or trailing comment
+    return number in block_lines or '//' in text or '/*' in text
+
+
+def gate_units(code: str, units: List[CodeUnit]) -> LLMGateDecision:
+    """
+    Keep the commented units that have a comment outside the file header
+
+    `units` are the file's commented units (code_units.commented_units).
+    """
+    if not units:
+        return LLMGateDecision([], SKIP_NO_COMMENTS)
+    lines = code.split('\n')
+    block_lines = block_comment_lines(lines)
+    header = file_header_lines(lines, block_lines)
+    kept = [
+        unit for unit in units
+        if any(n not in header and has_comment(lines[n - 1], n, block_lines)
+               for n in range(unit.start_line, unit.end_line + 1))
+    ]
+    if not kept:
+        return LLMGateDecision([], SKIP_HEADER_ONLY)
+    return LLMGateDecision(kept)
+
+
+def record_decision(skip_reason: Optional[str]) -> None:
+    """Count a per-file decision ("run" when the LLM was called)"""
+    metrics.increment("grader_llm_gate_total", decision=skip_reason or "run")
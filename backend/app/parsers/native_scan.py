@@ -0,0 +1,47 @@
+"""
+Optional compiled scanner for the Tier 1 line rules
+
+The extension module (built from backend/native/tier1_scan.cpp, see the
+README) scans the raw source buffer once, without creating a Python string
+per line, and returns compact records that the rules themselves turn into
+Violations via native_report(). The RuleEngine uses it for the rules
+that set `native` whenever the module is importable; otherwise, or with
+NATIVE_SCAN=false, the pure-Python rules run with identical results.
+
+Only ASCII sources are scanned natively: the Python rules rely on
+Unicode-aware str.strip(), \\s, \\w and \\b, which the scanner only
+reproduces for ASCII text.
+"""
+import os
+from typing import List, Optional, Set, Tuple
+
+try:
+    from app.parsers import _tier1_native
+except ImportError:
+    _tier1_native = None
+
+
+def available() -> bool:
+    return _tier1_native is not None
+
+
+def enabled() -> bool:
+    return available() and os.getenv("NATIVE_SCAN", "true").lower() != "false"
+
+
+def can_scan(source: Optional[str]) -> bool:
+    return source is not None and source.isascii() and enabled()
+
+
+def scan(source: str, rules: List) -> Tuple[int, Set[int]]:
+    """
+    Run the rules' native implementations over the source
+
+    Violations are added to each rule. Returns the number of lines and the
+    lines that start inside a block comment, as the Python scan would.
+    """
+    specs = [(rule.native, rule.native_param()) for rule in rules]
+    total_lines, block_lines, records = _tier1_native.scan(source, specs)
+    for index, kind, line_number, a, b, detail, snippet in records:
+        rules[index].native_report(kind, line_number, a, b, detail, snippet)
+    return total_lines, set(block_lines)
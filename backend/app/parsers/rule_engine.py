@@ -0,0 +1,403 @@
+"""
+Single-pass rule engine for the algorithmic (Tier 1) checks
+
+The scanner walks the source once and builds a LineRecord per line holding
+everything the line-based rules need (stripped text, indentation, comment
+state, brace counts). Rules are registered as visitors and are fed each
+record in turn, so adding a rule no longer adds another pass over the file.
+
+Token-level rules declare literal trigger strings; all triggers of the
+active rules are compiled into one alternation, so each line is searched
+once and only handed to the rules whose triggers occur on it.
+
+Rules with a compiled implementation are run by the native scanner
+(native_scan) instead when it is available, and the Python scan is skipped
+entirely when no other line rules remain.
+"""
+import logging
+import re
+import threading
+import time
+from collections import defaultdict
+from dataclasses import dataclass, field
+from typing import Any, Dict, FrozenSet, Iterable, Iterator, List, Optional, Set, Tuple
+from app.models.core import Violation
+from app.parsers import native_scan
+from app.services.metrics import record_rule
+
+logger = logging.getLogger(__name__)
+
+COMMENT_PREFIXES = ('//', '/*', '*')
+
+
+@dataclass
+class LineRecord:
+    """Shared per-line facts computed once by the scanner"""
+    number: int            # 1-based line number
+    text: str              # raw line without the newline
+    stripped: str          # text.strip()
+    indent_width: int      # number of leading whitespace characters
+    leading_char: str      # first character of the raw line ('' if empty)
+    leading_tabs: int      # count of leading '\t' characters
+    leading_spaces: int    # count of leading ' ' characters
+    is_blank: bool
+    is_comment: bool       # line starts with a comment marker or sits inside /* */
+    in_block_comment: bool  # line starts inside an unterminated /* */ block
+    is_preprocessor: bool
+    opens: int             # number of '{' on the line
+    closes: int            # number of '}' on the line
+
+    @property
+    def brace_delta(self) -> int:
+        return self.opens - self.closes
+
+
+def _ends_in_block_comment(text: str, in_block: bool) -> bool:
+    """Return whether a /* */ comment is still open at the end of the line"""
+    i = 0
+    while True:
+        if in_block:
+            end = text.find('*/', i)
+            if end == -1:
+                return True
+            i = end + 2
+            in_block = False
+        else:
+            start = text.find('/*', i)
+            line_comment = text.find('//', i)
+            if start == -1 or (line_comment != -1 and line_comment < start):
+                return False
+            i = start + 2
+            in_block = True
+
+
+def block_comment_lines(lines: Iterable[str]) -> Set[int]:
+    """Line numbers that start inside a /* */ comment, without building full records"""
+    inside: Set[int] = set()
+    in_block = False
+    for number, text in enumerate(lines, 1):
+        if in_block:
+            inside.add(number)
+        if in_block or '/*' in text:
+            in_block = _ends_in_block_comment(text, in_block)
+    return inside
+
+
+def scan_lines(lines: Iterable[str]) -> Iterator[LineRecord]:
+    """
+    Build LineRecords for an iterable of raw lines (without newlines)
+
+    Block comment state is carried between lines so that continuation
+    lines of a /* ... */ comment are marked as comments even when they
+    do not start with '*'.
+    """
+    in_block = False
+    for number, text in enumerate(lines, 1):
+        stripped = text.strip()
+        starts_in_block = in_block
+
+        if in_block or '/*' in stripped:
+            in_block = _ends_in_block_comment(stripped, in_block)
+
+        lstripped_len = len(text.lstrip())
+        yield LineRecord(
+            number=number,
+            text=text,
+            stripped=stripped,
+            indent_width=len(text) - lstripped_len,
+            leading_char=text[0] if text else '',
+            leading_tabs=len(text) - len(text.lstrip('\t')),
+            leading_spaces=len(text) - len(text.lstrip(' ')),
+            is_blank=not stripped,
+            is_comment=starts_in_block or stripped.startswith(COMMENT_PREFIXES),
+            in_block_comment=starts_in_block,
+            is_preprocessor=stripped.startswith('#'),
+            opens=stripped.count('{'),
+            closes=stripped.count('}'),
+        )
+
+
+class LineRule:
+    """
+    Base class for rules visited once per line by the RuleEngine
+
+    Subclasses override visit() and, for file-level findings, finish().
+    Violations are collected with report() and returned by the engine
+    in rule registration order.
+    """
+
+    name = "line_rule"
+
+    # "line" rules only look at a line (plus `context` lines of lookahead), so
+    # incremental runs can re-visit just the edited lines; "file" rules depend
+    # on the whole file and are re-run completely whenever anything changes.
+    scope = "file"
+    context = 0
+
+    # Literal substrings the rule needs on a line before visit() can report
+    # anything; None means every line is visited. Only for stateless rules,
+    # since skipped lines are never seen.
+    triggers: Optional[Tuple[str, ...]] = None
+
+    # Name of the rule's implementation in the compiled scanner (native_scan),
+    # if it has one; such rules also implement native_report()
+    native: Optional[str] = None
+
+    def __init__(self):
+        self.violations: List[Violation] = []
+        # When set, the engine only visits these line numbers (line-scope rules)
+        self.only_lines: Optional[Set[int]] = None
+        # When set, report() keeps at most this many violations of each type and
+        # only counts the rest in `omitted`, by (type, severity)
+        self.max_per_type: Optional[int] = None
+        self.omitted: Dict[Tuple[str, str], int] = {}
+        self._kept_by_type: Dict[str, int] = {}
+        # Without keep_snippets, violations are kept without their code_snippet and
+        # snippet_lines records (line, type) of those that had one, to read back later
+        self.keep_snippets = True
+        self.snippet_lines: Set[Tuple[int, str]] = set()
+
+    def signature(self) -> str:
+        """Identity of the rule and its configuration, used to reuse earlier results"""
+        return self.name
+
+    def visit(self, line: LineRecord, next_line: Optional[LineRecord]) -> None:
+        """Inspect a single line; next_line is the following record (or None at EOF)"""
+
+    def finish(self, total_lines: int) -> None:
+        """Called once after the last line has been visited"""
+
+    def native_param(self) -> int:
+        """Integer configuration passed to the native implementation"""
+        return 0
+
+    def native_report(self, kind: int, line_number: int, a: int, b: int,
+                      detail: Optional[str], snippet: Optional[str]) -> None:
+        """Turn one record of the native implementation into a violation"""
+        raise NotImplementedError(self.name)
+
+    def report(self, **fields) -> None:
+        if self.max_per_type is not None:
+            kind = fields.get("type", "general")
+            kept = self._kept_by_type.get(kind, 0)
+            if kept >= self.max_per_type:
+                severity = fields["severity"]
+                key = (kind, getattr(severity, "value", severity))
+                self.omitted[key] = self.omitted.get(key, 0) + 1
+                return
+            self._kept_by_type[kind] = kept + 1
+        if not self.keep_snippets and fields.pop("code_snippet", None) is not None:
+            self.snippet_lines.add((fields["line_number"], fields.get("type", "general")))
+        self.violations.append(Violation(**fields))
+
+    def clear(self) -> None:
+        """Drop everything reported so far"""
+        self.violations = []
+        self.omitted = {}
+        self._kept_by_type = {}
+        self.snippet_lines = set()
+
+
+class TreeRule(LineRule):
+    """
+    Base class for rules that query the shared tree-sitter parse tree
+
+    Tree rules are not visited per line; the engine calls check() once with
+    the file's ParsedFile after the line scan and before finish().
+    """
+
+    name = "tree_rule"
+
+    def check(self, parsed: Any) -> None:
+        """Inspect the parse tree of the file"""
+
+
+class TriggerMatcher:
+    """
+    Find which of a set of literal strings occur in a line with one regex
+
+    The literals are joined into a single alternation inside a lookahead so
+    overlapping occurrences are all seen; longer literals are tried first
+    and imply the shorter literals they contain.
+    """
+
+    def __init__(self, literals: Iterable[str]):
+        ordered = sorted(set(literals), key=len, reverse=True)
+        self.pattern = re.compile("(?=(" + "|".join(re.escape(lit) for lit in ordered) + "))")
+        self.implies: Dict[str, FrozenSet[str]] = {
+            lit: frozenset(other for other in ordered if other in lit) for lit in ordered
+        }
+
+    def find(self, text: str) -> Set[str]:
+        found: Set[str] = set()
+        for match in self.pattern.finditer(text):
+            literal = match.group(1)
+            if literal not in found:
+                found.update(self.implies[literal])
+        return found
+
+
+_matcher_cache: Dict[FrozenSet[str], TriggerMatcher] = {}
+_matcher_lock = threading.Lock()
+
+
+def trigger_matcher(literals: Iterable[str]) -> TriggerMatcher:
+    """Compiled matcher for a trigger set, built once per process"""
+    key = frozenset(literals)
+    matcher = _matcher_cache.get(key)
+    if matcher is None:
+        with _matcher_lock:
+            matcher = _matcher_cache.get(key)
+            if matcher is None:
+                matcher = _matcher_cache[key] = TriggerMatcher(key)
+    return matcher
+
+
+@dataclass
+class EngineRun:
+    """Results of a RuleEngine pass, grouped by rule signature"""
+    results: Dict[str, List[Violation]] = field(default_factory=dict)
+    total_lines: int = 0
+    # Lines that start inside a /* */ comment; incremental runs compare these
+    # between revisions because opening a block comment changes later lines
+    block_comment_lines: Set[int] = field(default_factory=set)
+    # Violations the rules counted but did not keep (LineRule.max_per_type)
+    omitted: Dict[Tuple[str, str], int] = field(default_factory=dict)
+
+    def violations(self) -> List[Violation]:
+        return [v for group in self.results.values() for v in group]
+
+
+class RuleEngine:
+    """Drive a set of LineRules over a single scan of the source"""
+
+    def compile(self, rules: Iterable[LineRule]) -> Optional[TriggerMatcher]:
+        """Precompile the trigger matcher for a rule set (also done lazily by run_lines)"""
+        literals = [t for r in rules if not isinstance(r, TreeRule) and r.triggers for t in r.triggers]
+        return trigger_matcher(literals) if literals else None
+
+    def run(self, code: str, rules: List[LineRule], parsed: Any = None) -> List[Violation]:
+        return self.run_lines(None, rules, parsed, source=code).violations()
+
+    def run_lines(
+        self,
+        lines: Optional[Iterable[str]],
+        rules: List[LineRule],
+        parsed: Any = None,
+        source: Optional[str] = None,
+        track_block_comments: bool = True
+    ) -> EngineRun:
+        """
+        Visit every line with every active rule, keeping one record of lookahead.
+
+        `source` is the text the lines were split from (lines may then be
+        None). It lets rules with a native implementation run in the compiled
+        scanner; incremental runs (rules restricted by only_lines) always use
+        the Python scan.
+
+        TreeRules are skipped during the line scan and instead receive the
+        shared parse tree; they are dropped when no tree is available.
+
+        A rule that raises is disabled for the rest of the file and its partial
+        results are discarded, matching the per-check isolation the analyzer
+        had when each check ran in its own loop.
+
+        Only one record of lookahead is held, so a lazy `lines` iterable is
+        scanned in constant memory; track_block_comments=False also leaves
+        EngineRun.block_comment_lines empty.
+
+        The time spent in each rule is summed over the file and recorded in
+        the grader_rule_seconds metric.
+        """
+        tree_rules = [r for r in rules if isinstance(r, TreeRule)]
+        active = [r for r in rules if not isinstance(r, TreeRule) or parsed is not None]
+        line_rules = [r for r in active if not isinstance(r, TreeRule)]
+        failed = set()
+        run = EngineRun()
+        rule_seconds: Dict[str, float] = defaultdict(float)
+        clock = time.perf_counter
+
+        native_rules = []
+        if native_scan.can_scan(source):
+            native_rules = [r for r in line_rules if r.native and r.only_lines is None]
+        if native_rules:
+            start = clock()
+            try:
+                run.total_lines, run.block_comment_lines = native_scan.scan(source, native_rules)
+            except Exception as e:
+                logger.error("Native scan failed, using the Python rules: %s", e)
+                for rule in native_rules:
+                    rule.clear()
+                native_rules = []
+            rule_seconds["native_scan"] += clock() - start
+        native_ids = {id(r) for r in native_rules}
+        line_rules = [r for r in line_rules if id(r) not in native_ids]
+
+        if lines is None and (line_rules or not native_rules):
+            lines = source.split('\n')
+        matcher = self.compile(line_rules)
+
+        def dispatch(record: LineRecord, next_record: Optional[LineRecord]) -> None:
+            found = matcher.find(record.text) if matcher is not None else None
+            for rule in line_rules:
+                if id(rule) in failed:
+                    continue
+                if rule.only_lines is not None and record.number not in rule.only_lines:
+                    continue
+                if rule.triggers and not found.intersection(rule.triggers):
+                    continue
+                start = clock()
+                try:
+                    rule.visit(record, next_record)
+                except Exception as e:
+                    logger.error("Error in %s: %s", rule.name, e)
+                    failed.add(id(rule))
+                rule_seconds[rule.name] += clock() - start
+
+        if line_rules or not native_rules:
+            previous: Optional[LineRecord] = None
+            for record in scan_lines(lines):
+                if record.in_block_comment and track_block_comments:
+                    run.block_comment_lines.add(record.number)
+                if previous is not None:
+                    dispatch(previous, record)
+                previous = record
+                run.total_lines = record.number
+            if previous is not None:
+                dispatch(previous, None)
+
+        if parsed is not None:
+            for rule in tree_rules:
+                start = clock()
+                try:
+                    rule.check(parsed)
+                except Exception as e:
+                    logger.error("Error in %s: %s", rule.name, e)
+                    failed.add(id(rule))
+                rule_seconds[rule.name] += clock() - start
+
+        def collect(rule: LineRule) -> None:
+            run.results.setdefault(rule.signature(), []).extend(rule.violations)
+            for key, count in rule.omitted.items():
+                run.omitted[key] = run.omitted.get(key, 0) + count
+
+        for rule in active:
+            if id(rule) in failed:
+                continue
+            if id(rule) in native_ids:
+                # finish() already ran inside the native scan
+                collect(rule)
+                continue
+            start = clock()
+            try:
+                rule.finish(run.total_lines)
+            except Exception as e:
+                logger.error("Error in %s: %s", rule.name, e)
+                continue
+            finally:
+                rule_seconds[rule.name] += clock() - start
+            collect(rule)
+
+        for name, seconds in rule_seconds.items():
+            record_rule(name, seconds)
+        return run
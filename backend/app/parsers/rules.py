@@ -0,0 +1,754 @@
+"""
+Rules for the algorithmic (Tier 1) checks
+
+Each rule is a LineRule visitor driven by the RuleEngine, so the whole set
+shares a single scan of the file. TreeRule variants query the file's shared
+tree-sitter parse instead and are used whenever the grammar is available.
+"""
+import re
+from array import array
+from bisect import bisect_left
+from typing import Optional
+from app.models.core import ViolationSeverity
+from app.parsers.cpp_parser import ParsedFile, function_declarator, function_name_node, last_identifier
+from app.parsers.rule_engine import LineRecord, LineRule, TreeRule
+
+
+PASCAL_CASE_RE = re.compile(r'^[A-Z][a-zA-Z0-9]*$')
+SNAKE_START_RE = re.compile(r'^[a-z_]')
+
+
+# --- Formatting checks (always run) ---
+
+class IndentationRule(LineRule):
+    """Check for proper indentation based on brace nesting levels"""
+
+    name = "proper_indentation"
+    native = "indentation"
+
+    def __init__(self):
+        super().__init__()
+        self.uses_tabs: Optional[bool] = None
+        self.indent_size = 4  # Use standard: 4 spaces = 1 tab = 1 level
+        self.mixed = False
+        self.expected_level = 0
+        self.in_switch = False
+
+    def visit(self, line: LineRecord, next_line: Optional[LineRecord]) -> None:
+        if self.mixed:
+            return
+
+        # Determine tabs vs spaces from the first indented line; any later
+        # line that starts with the other character means the file mixes both
+        if not line.is_blank and line.indent_width > 0:
+            if line.leading_char == '\t':
+                if self.uses_tabs is False:
+                    self.mixed = True
+                    return
+                self.uses_tabs = True
+            elif line.leading_char == ' ':
+                if self.uses_tabs is True:
+                    self.mixed = True
+                    return
+                self.uses_tabs = False
+
+        stripped = line.stripped
+
+        # Skip empty lines and preprocessor directives
+        if line.is_blank or line.is_preprocessor:
+            return
+
+        # Calculate current indentation level
+        if self.uses_tabs:
+            current_indent = line.leading_tabs
+        else:
+            current_indent = line.leading_spaces // self.indent_size
+
+        # Track if we're in a switch statement
+        if 'switch' in stripped and line.opens:
+            self.in_switch = True
+
+        # Check for closing braces (decrease expected level before checking)
+        closes_first = stripped.startswith('}')
+        if closes_first:
+            self.expected_level = max(0, self.expected_level - 1)
+            self.in_switch = False
+
+        # Check if indentation matches expected level
+        if current_indent != self.expected_level and not closes_first:
+            # Allow flexibility for:
+            # - Labels (anything ending with :)
+            # - Access specifiers
+            # - Case statements and their contents (allow expected_level OR expected_level + 1)
+            is_label = stripped.endswith(':')
+            is_case_related = stripped.startswith('case ') or stripped.startswith('default')
+            is_inside_switch = self.in_switch and (current_indent == self.expected_level + 1 or is_case_related)
+
+            if not (is_label or is_inside_switch):
+                self._report_level(line.number, current_indent, self.expected_level, line.text.rstrip())
+
+        # Check for opening braces (increase expected level after this line)
+        if line.opens and not closes_first:
+            self.expected_level += line.brace_delta
+
+    def finish(self, total_lines: int) -> None:
+        if self.mixed:
+            self.clear()
+            self._report_mixed()
+        elif self.uses_tabs is None:
+            # No indented lines found
+            self.clear()
+
+    def native_report(self, kind, line_number, a, b, detail, snippet) -> None:
+        if kind == 0:
+            self._report_level(line_number, a, b, snippet)
+        else:
+            self._report_mixed()
+
+    def _report_level(self, line_number: int, current: int, expected: int, snippet: str) -> None:
+        self.report(
+            type="improper_indentation",
+            severity=ViolationSeverity.WARNING,
+            line_number=line_number,
+            description=f"Indentation level {current} does not match expected nesting level {expected}",
+            rule_reference="Proper Indentation",
+            code_snippet=snippet
+        )
+
+    def _report_mixed(self) -> None:
+        self.report(
+            type="mixed_indentation",
+            severity=ViolationSeverity.WARNING,
+            line_number=1,
+            description="File mixes tabs and spaces for indentation. Use one consistently.",
+            rule_reference="Consistent Indentation"
+        )
+
+
+class LineLengthRule(LineRule):
+    """Check for extremely long lines"""
+
+    name = "line_length"
+    scope = "line"
+    native = "line_length"
+
+    def __init__(self, max_length: int = 200):
+        super().__init__()
+        self.max_length = max_length
+
+    def signature(self) -> str:
+        return f"{self.name}:{self.max_length}"
+
+    def native_param(self) -> int:
+        return self.max_length
+
+    def visit(self, line: LineRecord, next_line: Optional[LineRecord]) -> None:
+        length = len(line.text)
+        if length > self.max_length:
+            self._report_length(line.number, length, line.text[:100] + "..." if length > 100 else line.text)
+
+    def native_report(self, kind, line_number, a, b, detail, snippet) -> None:
+        self._report_length(line_number, a, snippet)
+
+    def _report_length(self, line_number: int, length: int, snippet: str) -> None:
+        self.report(
+            type="line_too_long",
+            severity=ViolationSeverity.MINOR,
+            line_number=line_number,
+            description=f"Line is {length} characters long (exceeds {self.max_length} character limit)",
+            rule_reference="Maximum Line Length",
+            code_snippet=snippet
+        )
+
+
+class SingleLineIfRule(LineRule):
+    """Check for single-line if statements without braces"""
+
+    name = "single_line_if_statements"
+    scope = "line"
+    context = 1  # looks at the following line
+    triggers = ("if", "for", "while")
+    native = "single_line_if"
+
+    keyword_re = re.compile(r'^\s*(if|else\s+if|for|while)\s*\(')
+
+    def visit(self, line: LineRecord, next_line: Optional[LineRecord]) -> None:
+        text = line.text
+
+        # Match if/for/while at the start
+        keyword_match = self.keyword_re.match(text)
+        if not keyword_match:
+            return
+
+        # Find the matching closing parenthesis by counting parens
+        paren_count = 0
+        paren_end = -1
+        for pos in range(keyword_match.end() - 1, len(text)):
+            if text[pos] == '(':
+                paren_count += 1
+            elif text[pos] == ')':
+                paren_count -= 1
+                if paren_count == 0:
+                    paren_end = pos
+                    break
+
+        if paren_end == -1:
+            # Couldn't find matching paren, skip
+            return
+
+        # Check what comes after the closing paren
+        remainder = text[paren_end + 1:].strip()
+
+        # If there's a brace on same line, it's OK
+        if remainder.startswith('{'):
+            return
+
+        # A one-liner, or a next line that doesn't open a block, is a violation
+        if remainder and not remainder.startswith('//'):
+            self._report_missing(line.number, line.stripped)
+        elif next_line is not None:
+            next_stripped = next_line.stripped
+            if next_stripped and not next_stripped.startswith('{') and not next_stripped.startswith('//'):
+                self._report_missing(line.number, line.stripped)
+
+    def native_report(self, kind, line_number, a, b, detail, snippet) -> None:
+        self._report_missing(line_number, snippet)
+
+    def _report_missing(self, line_number: int, snippet: str) -> None:
+        self.report(
+            type="missing_braces",
+            severity=ViolationSeverity.WARNING,
+            line_number=line_number,
+            description="Control structure should use braces even for single statements",
+            rule_reference="Always Use Braces",
+            code_snippet=snippet
+        )
+
+
+class FileHeaderCommentRule(LineRule):
+    """Check for file header comment in first 10 lines"""
+
+    name = "file_header_comment"
+    native = "file_header"
+    header_lines = 10
+
+    def __init__(self):
+        super().__init__()
+        self.has_header_comment = False
+
+    def visit(self, line: LineRecord, next_line: Optional[LineRecord]) -> None:
+        if line.number <= self.header_lines and line.is_comment:
+            self.has_header_comment = True
+
+    def finish(self, total_lines: int) -> None:
+        if not self.has_header_comment:
+            self.native_report(0, 1, 0, 0, None, None)
+
+    def native_report(self, kind, line_number, a, b, detail, snippet) -> None:
+        self.report(
+            type="missing_file_header",
+            severity=ViolationSeverity.MINOR,
+            line_number=line_number,
+            description="File should have a header comment describing its purpose",
+            rule_reference="File Header Comment"
+        )
+
+
+class NoCommentsRule(LineRule):
+    """CRITICAL: Check if file has NO comments (excluding header comments)"""
+
+    name = "no_comments"
+    native = "no_comments"
+    header_lines = 10
+
+    def __init__(self):
+        super().__init__()
+        self.has_non_header_comment = False
+
+    def visit(self, line: LineRecord, next_line: Optional[LineRecord]) -> None:
+        # Only check lines after the header
+        if line.number > self.header_lines and line.is_comment:
+            self.has_non_header_comment = True
+
+    def finish(self, total_lines: int) -> None:
+        if not self.has_non_header_comment:
+            self.native_report(0, 11, 0, 0, None, None)
+
+    def native_report(self, kind, line_number, a, b, detail, snippet) -> None:
+        self.report(
+            type="no_comments",
+            severity=ViolationSeverity.CRITICAL,
+            line_number=line_number,
+            description="File contains NO comments beyond the header. Code must be documented for maintainability.",
+            rule_reference="Code Documentation"
+        )
+
+
+# --- Algorithmic semantic checks ---
+
+class MemoryLeakRule(LineRule):
+    """
+    Detect simple memory leaks - new without corresponding delete
+
+    Deletes and uses are indexed by variable name in line order, so matching
+    an allocation is a binary search even when many functions reuse a name.
+
+    A pointer declared with its allocation ('int* p = new int') belongs to
+    its enclosing block: it is only freed by a delete inside that block,
+    unless ownership leaves the block (returned, assigned elsewhere, stored
+    in a container or handed to a smart pointer) or it is passed to a helper
+    and a delete of that name exists. Allocations assigned to existing names
+    or members ('p = new ...', ': data_(new ...)') may be freed anywhere,
+    e.g. in a destructor.
+    """
+
+    name = "memory_leaks"
+    # No triggers: scopes, allocations, deletes and ownership transfers are
+    # read from every line, so the rule visits all of them
+
+    new_assign_re = re.compile(r'(\w+)\s*=\s*new\s+')
+    new_array_re = re.compile(r'new\s+\w+\[')
+    member_init_re = re.compile(r'[:,]\s*(\w+)\s*[({]\s*new\s')
+    delete_array_re = re.compile(r'delete\s*\[\s*\]?\s*(\w+)')
+    delete_re = re.compile(r'delete\s+(\w+)')
+
+    return_re = re.compile(r'\breturn\s+(\w+)\s*;')
+    assign_from_re = re.compile(r'[^=!<>]=\s*(\w+)\s*[;,)]')
+    owner_call_re = re.compile(r'\b(?:push_back|push_front|push|emplace_back|emplace|insert|reset|add|append)\s*\(\s*(\w+)\s*\)')
+    smart_ptr_re = re.compile(r'_ptr\s*<[^;]*>\s*\w*\s*[({]\s*(\w+)\s*[)}]')
+    call_re = re.compile(r'\b(\w+)\s*\(([^()]*)\)')
+    not_calls = frozenset(("if", "for", "while", "switch", "return", "sizeof", "catch"))
+    owner_calls = frozenset(("push_back", "push_front", "push", "emplace_back", "emplace", "insert",
+                             "reset", "add", "append"))
+
+    def __init__(self):
+        super().__init__()
+        # Scopes are [first line, last line]; the last line is None while open
+        self.file_scope = [1, None]
+        self.scope_stack = [self.file_scope]
+        self.allocations = []
+        self.deletes = {}     # var -> [(line, is_array)]
+        # Line numbers are kept in arrays: these index every use of a name, so
+        # they grow with the file
+        self.transfers = {}   # var -> array of lines where ownership leaves the variable
+        self.passed = {}      # var -> array of lines where it is passed to another function
+
+    # --- collection (line scan) ---
+
+    def visit(self, line: LineRecord, next_line: Optional[LineRecord]) -> None:
+        if line.is_comment:
+            return
+        stripped = line.stripped
+
+        # Find new allocations
+        alloc = self._find_allocation(stripped) if ('new ' in stripped or 'new[' in stripped) else None
+        if line.opens or line.closes:
+            split = alloc[0] if alloc else len(stripped)
+            self._track_braces(stripped[:split], line.number)
+            if alloc:
+                self._add_allocation(line.number, alloc[1], alloc[2], self.scope_stack[-1] if alloc[3] else None)
+            self._track_braces(stripped[split:], line.number)
+        elif alloc:
+            self._add_allocation(line.number, alloc[1], alloc[2], self.scope_stack[-1] if alloc[3] else None)
+
+        # Find delete statements
+        if 'delete ' in stripped or 'delete[]' in stripped:
+            match = self.delete_array_re.search(stripped)
+            if not match:
+                match = self.delete_re.search(stripped)
+            if match:
+                self._add_delete(line.number, match.group(1), 'delete[]' in stripped or 'delete [' in stripped)
+
+        if 'return' in stripped or '=' in stripped or '(' in stripped:
+            self._track_uses(stripped, line.number)
+
+    def _find_allocation(self, text: str):
+        """(position, variable, is_array, declared here) of an allocation on the line, or None"""
+        is_array = 'new[]' in text or bool(self.new_array_re.search(text))
+        match = self.new_assign_re.search(text)
+        if match:
+            before = text[:match.start(1)].rstrip()
+            # 'int* p = new', 'auto p = new' declare p; 'p = new', 'x->p = new' assign
+            declared = before.endswith('*') or before.endswith('auto')
+            return match.start(), match.group(1), is_array, declared
+        match = self.member_init_re.search(text)
+        if match:
+            return match.start(), match.group(1), is_array, False
+        return None
+
+    def _track_braces(self, text: str, line_number: int) -> None:
+        for ch in text:
+            if ch == '{':
+                scope = [line_number, None]
+                self.scope_stack.append(scope)
+            elif ch == '}' and len(self.scope_stack) > 1:
+                self.scope_stack.pop()[1] = line_number
+
+    def _track_uses(self, text: str, line_number: int) -> None:
+        for regex in (self.return_re, self.assign_from_re, self.owner_call_re, self.smart_ptr_re):
+            for match in regex.finditer(text):
+                self.transfers.setdefault(match.group(1), array('l')).append(line_number)
+        for match in self.call_re.finditer(text):
+            if match.group(1) in self.not_calls:
+                continue
+            for arg in match.group(2).split(','):
+                arg = arg.strip()
+                if arg.isidentifier():
+                    self.passed.setdefault(arg, array('l')).append(line_number)
+
+    def _add_allocation(self, line_number: int, var: str, is_array: bool, scope) -> None:
+        self.allocations.append({
+            'line': line_number,
+            'var': var,
+            'is_array': is_array,
+            'scope': scope,  # None: may be freed anywhere in the file
+            'matched': False
+        })
+
+    def _add_delete(self, line_number: int, var: str, is_array: bool) -> None:
+        self.deletes.setdefault(var, []).append((line_number, is_array))
+
+    # --- matching ---
+
+    def _find_delete(self, alloc, total_lines: int):
+        """The delete that frees an allocation, True if ownership was transferred, or None"""
+        deletes = self.deletes.get(alloc['var'], [])
+        scope = alloc['scope']
+        if scope is None:
+            return deletes[0] if deletes else None
+
+        # The per-name lists are filled in line order, so the first entry at or
+        # after the scope start is the only one that can fall inside the scope
+        first, last = scope[0], scope[1] if scope[1] is not None else total_lines
+        index = bisect_left(deletes, (first,))
+        if index < len(deletes) and deletes[index][0] <= last:
+            return deletes[index]
+        if self._used_within(self.transfers.get(alloc['var']), first, last):
+            return True
+        # Handed to a helper that frees a parameter of the same name
+        if deletes and self._used_within(self.passed.get(alloc['var']), first, last):
+            return deletes[0]
+        return None
+
+    @staticmethod
+    def _used_within(lines, first: int, last: int) -> bool:
+        if not lines:
+            return False
+        index = bisect_left(lines, first)
+        return index < len(lines) and lines[index] <= last
+
+    def finish(self, total_lines: int) -> None:
+        # Match news with deletes
+        for new in self.allocations:
+            delete = self._find_delete(new, total_lines)
+            if delete is None:
+                continue
+            new['matched'] = True
+            if delete is True:
+                continue
+            # Check for delete/delete[] mismatch
+            delete_is_array = delete[1]
+            if new['is_array'] and not delete_is_array:
+                self.report(
+                    type="wrong_delete_type",
+                    severity=ViolationSeverity.CRITICAL,
+                    line_number=new['line'],
+                    description="Array allocated with 'new[]' but deleted with 'delete' (should use 'delete[]')",
+                    rule_reference="Memory Management"
+                )
+            elif not new['is_array'] and delete_is_array:
+                self.report(
+                    type="wrong_delete_type",
+                    severity=ViolationSeverity.CRITICAL,
+                    line_number=new['line'],
+                    description="Single object allocated with 'new' but deleted with 'delete[]' (should use 'delete')",
+                    rule_reference="Memory Management"
+                )
+
+        # Report unmatched news as memory leaks
+        for new in self.allocations:
+            if not new['matched']:
+                delete_type = "delete[]" if new['is_array'] else "delete"
+                self.report(
+                    type="memory_leak",
+                    severity=ViolationSeverity.CRITICAL,
+                    line_number=new['line'],
+                    description=f"Memory allocated with 'new' but no corresponding '{delete_type}' found for variable '{new['var']}'",
+                    rule_reference="Memory Management"
+                )
+
+
+class NamingConventionRule(LineRule):
+    """Check for camelCase functions and PascalCase classes"""
+
+    name = "naming_conventions"
+    scope = "line"
+    triggers = ("class", "(")
+
+    class_re = re.compile(r'\bclass\s+([a-zA-Z_]\w*)')
+    func_re = re.compile(r'\b([a-z_]\w*)\s*\([^)]*\)\s*[{;]')
+
+    def visit(self, line: LineRecord, next_line: Optional[LineRecord]) -> None:
+        # Skip comments and preprocessor directives
+        if line.is_comment or line.is_preprocessor:
+            return
+        stripped = line.stripped
+
+        # Check class names (should be PascalCase)
+        class_match = self.class_re.search(stripped)
+        if class_match:
+            class_name = class_match.group(1)
+            # PascalCase: starts with uppercase, no underscores
+            if not PASCAL_CASE_RE.match(class_name):
+                self.report(
+                    type="naming_convention",
+                    severity=ViolationSeverity.WARNING,
+                    line_number=line.number,
+                    description=f"Class '{class_name}' should use PascalCase (e.g., 'MyClass')",
+                    rule_reference="Naming Conventions",
+                    code_snippet=stripped
+                )
+
+        # Check function names (should be camelCase)
+        # Match: return_type function_name(
+        func_match = self.func_re.search(stripped)
+        if func_match and 'if' not in stripped and 'for' not in stripped and 'while' not in stripped and 'switch' not in stripped:
+            func_name = func_match.group(1)
+            # Exclude main and common keywords
+            if func_name not in ['main', 'if', 'for', 'while', 'switch', 'return'] and '_' in func_name:
+                self.report(
+                    type="naming_convention",
+                    severity=ViolationSeverity.WARNING,
+                    line_number=line.number,
+                    description=f"Function '{func_name}' should use camelCase, not snake_case (e.g., 'myFunction')",
+                    rule_reference="Naming Conventions",
+                    code_snippet=stripped
+                )
+
+
+class MagicNumberRule(LineRule):
+    """Detect hardcoded numeric literals (magic numbers)"""
+
+    name = "magic_numbers"
+    scope = "line"
+    triggers = tuple("0123456789")
+    native = "magic_numbers"
+
+    number_re = re.compile(r'\b(\d+\.?\d*)\b')
+    loop_header_re = re.compile(r'(for|while)\s*\(([^)]*)')
+
+    def visit(self, line: LineRecord, next_line: Optional[LineRecord]) -> None:
+        # Skip comments, preprocessor, and includes
+        if line.is_comment or line.is_preprocessor:
+            return
+        stripped = line.stripped
+
+        # Find numeric literals that aren't 0, 1
+        loop_headers = None
+        for num in self.number_re.findall(stripped):
+            if num in ['0', '1']:
+                continue
+
+            # Skip if in loop context
+            if loop_headers is None:
+                loop_headers = [m.group(2) for m in self.loop_header_re.finditer(stripped)]
+            if any(num in header for header in loop_headers):
+                continue
+
+            # Skip if it looks like array size or index
+            if f'[{num}]' in stripped:
+                continue
+
+            self.native_report(0, line.number, 0, 0, num, stripped)
+            break  # Only report once per line
+
+    def native_report(self, kind, line_number, a, b, detail, snippet) -> None:
+        self.report(
+            type="magic_number",
+            severity=ViolationSeverity.WARNING,
+            line_number=line_number,
+            description=f"Magic number '{detail}' should be a named constant (e.g., 'const int MAX_SIZE = {detail}')",
+            rule_reference="Magic Numbers",
+            code_snippet=snippet
+        )
+
+
+class NullVsNullptrRule(LineRule):
+    """Check for NULL usage instead of nullptr"""
+
+    name = "null_vs_nullptr"
+    scope = "line"
+    triggers = ("NULL",)
+    native = "null_vs_nullptr"
+
+    null_re = re.compile(r'\bNULL\b')
+
+    def visit(self, line: LineRecord, next_line: Optional[LineRecord]) -> None:
+        # Skip comments and preprocessor lines (e.g. #define NULL)
+        if line.is_comment or line.is_preprocessor:
+            return
+        if self.null_re.search(line.stripped):
+            self.native_report(0, line.number, 0, 0, None, line.stripped)
+
+    def native_report(self, kind, line_number, a, b, detail, snippet) -> None:
+        self.report(
+            type="use_nullptr",
+            severity=ViolationSeverity.WARNING,
+            line_number=line_number,
+            description="Use 'nullptr' instead of 'NULL' in modern C++",
+            rule_reference="Modern C++ Practices",
+            code_snippet=snippet
+        )
+
+
+# --- Tree-based checks (query the shared parse tree) ---
+
+class NamingConventionTreeRule(TreeRule):
+    """
+    Check for camelCase functions and PascalCase classes using the parse tree
+
+    Unlike the line regex this only looks at declarations and definitions,
+    so calls to library functions and multi-line signatures are handled.
+    """
+
+    name = "naming_conventions"
+
+    def check(self, parsed: ParsedFile) -> None:
+        for node in parsed.nodes("class_specifier", "function_definition", "declaration", "field_declaration"):
+            if node.type == "class_specifier":
+                name_node = node.child_by_field_name("name")
+                if name_node is None:
+                    continue
+                class_name = parsed.text(name_node)
+                if not PASCAL_CASE_RE.match(class_name):
+                    line_number = name_node.start_point[0] + 1
+                    self.report(
+                        type="naming_convention",
+                        severity=ViolationSeverity.WARNING,
+                        line_number=line_number,
+                        description=f"Class '{class_name}' should use PascalCase (e.g., 'MyClass')",
+                        rule_reference="Naming Conventions",
+                        code_snippet=parsed.line_text(line_number)
+                    )
+                continue
+
+            # Prototypes are declarations whose declarator is a function_declarator
+            if node.type != "function_definition" and function_declarator(node) is None:
+                continue
+            name_node = function_name_node(node)
+            if name_node is None or name_node.type not in ("identifier", "field_identifier"):
+                continue
+            func_name = parsed.text(name_node)
+            if func_name != 'main' and '_' in func_name and SNAKE_START_RE.match(func_name):
+                line_number = name_node.start_point[0] + 1
+                self.report(
+                    type="naming_convention",
+                    severity=ViolationSeverity.WARNING,
+                    line_number=line_number,
+                    description=f"Function '{func_name}' should use camelCase, not snake_case (e.g., 'myFunction')",
+                    rule_reference="Naming Conventions",
+                    code_snippet=parsed.line_text(line_number)
+                )
+
+
+class MemoryLeakTreeRule(MemoryLeakRule, TreeRule):
+    """
+    new/delete matching driven by the parse tree
+
+    Allocations spanning several lines or sharing a line with comments are
+    found reliably, and blocks come from compound_statement nodes instead
+    of brace counting; matching and reporting are inherited from
+    MemoryLeakRule.
+    """
+
+    name = "memory_leaks"
+
+    def visit(self, line: LineRecord, next_line: Optional[LineRecord]) -> None:
+        pass
+
+    def check(self, parsed: ParsedFile) -> None:
+        for node in parsed.nodes("new_expression", "delete_expression", "return_statement",
+                                 "assignment_expression", "init_declarator", "call_expression"):
+            line_number = node.start_point[0] + 1
+            if node.type == "new_expression":
+                target = self._allocation_target(node)
+                if target is None:
+                    continue
+                var_node, declared = target
+                self._add_allocation(
+                    line_number,
+                    parsed.text(var_node),
+                    node.child_by_field_name("declarator") is not None,
+                    self._enclosing_block(node) if declared else None
+                )
+            elif node.type == "delete_expression":
+                operand = node.named_children[-1] if node.named_children else None
+                target = last_identifier(operand) if operand is not None else None
+                if target is None:
+                    continue
+                self._add_delete(line_number, parsed.text(target), any(child.type == '[' for child in node.children))
+            elif node.type == "return_statement":
+                self._transfer(parsed, node.named_children[0] if node.named_children else None, line_number)
+            elif node.type == "assignment_expression":
+                self._transfer(parsed, node.child_by_field_name("right"), line_number)
+            elif node.type == "init_declarator":
+                value = node.child_by_field_name("value")
+                if value is not None and value.type in ("argument_list", "initializer_list"):
+                    # 'std::unique_ptr<Node> owner(raw)' takes ownership of raw
+                    for arg in value.named_children:
+                        self._transfer(parsed, arg, line_number)
+                else:
+                    self._transfer(parsed, value, line_number)
+            else:
+                self._track_call(parsed, node, line_number)
+
+    def _transfer(self, parsed: ParsedFile, node, line_number: int) -> None:
+        if node is not None and node.type == "identifier":
+            self.transfers.setdefault(parsed.text(node), array('l')).append(line_number)
+
+    def _track_call(self, parsed: ParsedFile, node, line_number: int) -> None:
+        function = node.child_by_field_name("function")
+        arguments = node.child_by_field_name("arguments")
+        if function is None or arguments is None:
+            return
+        callee = last_identifier(function)
+        callee_name = parsed.text(callee) if callee is not None else ""
+        owning = callee_name in self.owner_calls or "_ptr" in parsed.text(function)
+        for arg in arguments.named_children:
+            if arg.type != "identifier":
+                continue
+            uses = self.transfers if owning else self.passed
+            uses.setdefault(parsed.text(arg), array('l')).append(line_number)
+
+    def _allocation_target(self, node):
+        """
+        (variable node, declared here) for the variable receiving an allocation:
+        'int* p = new int' declares p, 'p = new int' and ': data_(new int)' assign to it
+        """
+        parent = node.parent
+        if parent is None:
+            return None
+        if parent.type == "init_declarator":
+            declarator = parent.child_by_field_name("declarator")
+            # Default member initializers belong to the object, not a block
+            declared = parent.parent is not None and parent.parent.type == "declaration"
+        elif parent.type == "assignment_expression":
+            declarator = parent.child_by_field_name("left")
+            declared = False
+        elif parent.type == "argument_list" and parent.parent is not None and parent.parent.type == "field_initializer":
+            declarator = parent.parent.named_children[0] if parent.parent.named_children else None
+            declared = False
+        else:
+            return None
+        target = last_identifier(declarator) if declarator is not None else None
+        return (target, declared) if target is not None else None
+
+    def _enclosing_block(self, node):
+        """[first line, last line] of the block declaring a local, or None at file/namespace scope"""
+        parent = node.parent
+        while parent is not None and parent.type != "compound_statement":
+            parent = parent.parent
+        if parent is None:
+            return None
+        return [parent.start_point[0] + 1, parent.end_point[0] + 1]
+
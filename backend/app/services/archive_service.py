@@ -0,0 +1,87 @@
+"""
+Entry-by-entry extraction of submission archives (zip, tar, tar.gz)
+"""
+import posixpath
+import tarfile
+import zipfile
+from dataclasses import dataclass
+from typing import BinaryIO, Iterator, Optional, Set
+
+ARCHIVE_SUFFIXES = (".zip", ".tar", ".tar.gz", ".tgz")
+
+
+@dataclass
+class ArchiveEntry:
+    """A member of an archive; content is None when the entry was skipped"""
+    path: str
+    content: Optional[bytes] = None
+    skipped: Optional[str] = None  # reason the entry was not extracted
+
+
+def is_archive(filename: str) -> bool:
+    return filename.lower().endswith(ARCHIVE_SUFFIXES)
+
+
+def safe_member_path(name: str) -> Optional[str]:
+    """Normalized relative path of an archive member, or None if it escapes the archive root"""
+    path = posixpath.normpath(name.replace("\\", "/")).lstrip("/")
+    if not path or path == "." or path.startswith("../") or path == "..":
+        return None
+    return path
+
+
+def _read_limited(stream: BinaryIO, max_size: int) -> Optional[bytes]:
+    # Read one byte past the limit so oversized (or lying) entries are detected
+    # without decompressing them completely
+    data = stream.read(max_size + 1)
+    return None if len(data) > max_size else data
+
+
+def iter_archive(
+    fileobj: BinaryIO,
+    filename: str,
+    allowed_extensions: Set[str],
+    max_size: int
+) -> Iterator[ArchiveEntry]:
+    """
+    Yield the C++ sources of an archive one entry at a time
+
+    Tar archives are read as a stream; zip archives need a seekable file
+    for their central directory, but each member is still decompressed on
+    its own. Directories, links and files outside the extension allow-list
+    are skipped silently; unsafe paths and oversized files are reported.
+    """
+    def wanted(path: str) -> bool:
+        return posixpath.splitext(path)[1].lower() in allowed_extensions
+
+    if filename.lower().endswith(".zip"):
+        with zipfile.ZipFile(fileobj) as archive:
+            for info in archive.infolist():
+                if info.is_dir() or not wanted(info.filename):
+                    continue
+                path = safe_member_path(info.filename)
+                if path is None:
+                    yield ArchiveEntry(info.filename, skipped="unsafe path")
+                elif info.file_size > max_size:
+                    yield ArchiveEntry(path, skipped="file size exceeds limit")
+                else:
+                    with archive.open(info) as member:
+                        data = _read_limited(member, max_size)
+                    if data is None:
+                        yield ArchiveEntry(path, skipped="file size exceeds limit")
+                    else:
+                        yield ArchiveEntry(path, data)
+        return
+
+    with tarfile.open(fileobj=fileobj, mode="r|*") as archive:
+        for info in archive:
+            if not info.isfile() or not wanted(info.name):
+                continue
+            path = safe_member_path(info.name)
+            if path is None:
+                yield ArchiveEntry(info.name, skipped="unsafe path")
+            elif info.size > max_size:
+                yield ArchiveEntry(path, skipped="file size exceeds limit")
+            else:
+                member = archive.extractfile(info)
+                yield ArchiveEntry(path, member.read() if member is not None else b"")
@@ -0,0 +1,241 @@
+"""
+Batch analysis of many files against one style guide
+"""
+import asyncio
+import logging
+import os
+from concurrent.futures import ProcessPoolExecutor
+from concurrent.futures.process import BrokenProcessPool
+from typing import Dict, List, Optional, Tuple
+from app.models.core import AnalysisResult, BatchAnalysisResult, BatchAnalysisSummary, StyleGuideRulePlan
+from app.parsers.cpp_analyzer import ANALYZER_VERSION, CppAnalyzer, run_tier1_checks, streaming_analysis_bytes
+from app.parsers.incremental import AnalysisSnapshot
+from app.services.similarity_index import get_similarity_index, near_duplicate_reuse
+
+logger = logging.getLogger(__name__)
+
+
+def _streamed(file_data: Dict) -> bool:
+    """Whether a file record is a large stored file to analyze with analyze_lines"""
+    return hasattr(file_data, "lines") and file_data.get("size", 0) > streaming_analysis_bytes()
+
+
+class BatchAnalysisService:
+    """
+    Run the analyzer over a whole assignment
+
+    The algorithmic checks are CPU-bound, so they run in a process pool
+    (BATCH_WORKERS processes, default: one per core) instead of on the event
+    loop; they also return the commented code units for the LLM comment
+    check, whose requests OllamaService spreads over its pool of Ollama
+    hosts (OLLAMA_HOSTS), each with its own limit on requests in flight.
+    Results go through the same result cache as single-file analysis.
+
+    Near-identical files (e.g. copies of the starter code) are grouped with
+    the similarity index: each group's first file is analyzed in full and
+    the others as revisions of it, so only the lines that differ are
+    re-checked and unchanged comments are not sent to the LLM again.
+
+    Stored files above STREAMING_ANALYSIS_BYTES are analyzed line by line
+    from the file store (CppAnalyzer.analyze_lines) and never loaded whole.
+    """
+
+    def __init__(self, analyzer: CppAnalyzer):
+        self.analyzer = analyzer
+        self.max_workers = int(os.getenv("BATCH_WORKERS", "0")) or os.cpu_count() or 1
+        self._pool: Optional[ProcessPoolExecutor] = None
+
+    def _get_pool(self) -> ProcessPoolExecutor:
+        if self._pool is None:
+            self._pool = ProcessPoolExecutor(max_workers=self.max_workers)
+        return self._pool
+
+    def shutdown(self) -> None:
+        if self._pool is not None:
+            self._pool.shutdown(wait=False, cancel_futures=True)
+            self._pool = None
+
+    async def _run_checks(self, file_content: str, check_magic_numbers: bool):
+        loop = asyncio.get_running_loop()
+        try:
+            return await loop.run_in_executor(self._get_pool(), run_tier1_checks, file_content, check_magic_numbers)
+        except BrokenProcessPool:
+            # A worker died (e.g. killed for memory); start a fresh pool next time
+            logger.warning("Batch worker pool broke, running checks in-process")
+            self._pool = None
+            return run_tier1_checks(file_content, check_magic_numbers)
+
+    async def analyze_file(
+        self,
+        file_data: Dict,
+        style_guide: str,
+        use_rag: bool,
+        rule_plan: StyleGuideRulePlan
+    ) -> AnalysisResult:
+        """Analyze one uploaded file; failures are returned as error results"""
+        result, _ = await self._analyze(file_data, style_guide, use_rag, rule_plan)
+        return result
+
+    async def _analyze(
+        self,
+        file_data: Dict,
+        style_guide: str,
+        use_rag: bool,
+        rule_plan: StyleGuideRulePlan
+    ) -> Tuple[AnalysisResult, Optional[AnalysisSnapshot]]:
+        """analyze_file, also returning a snapshot (without parse tree) for near-duplicates to start from"""
+        file_name = file_data["name"]
+        file_path = file_data.get("path") or file_name
+        analyzer = self.analyzer
+        if _streamed(file_data):
+            result = await analyzer.analyze_lines(
+                file_data.lines(), file_data.blob, file_name, file_path, style_guide, use_rag, rule_plan
+            )
+            return result, None
+        # Reading the body is blocking (see app.services.file_store)
+        file_content = await asyncio.to_thread(file_data.__getitem__, "content")
+
+        try:
+            cache_key = analyzer.result_cache.make_key(
+                file_content, style_guide, use_rag, ANALYZER_VERSION, analyzer.ollama_service.comment_review_config()
+            )
+            cached = analyzer.result_cache.get(cache_key)
+            if cached is not None:
+                return cached.model_copy(update={
+                    "file_name": file_name,
+                    "file_path": file_path,
+                    "cached": True,
+                    "incremental": False
+                }), None
+
+            formatting, semantic, units, run = await self._run_checks(file_content, rule_plan.check_magic_numbers)
+            violations = formatting + semantic
+
+            llm_violations = None
+            llm_failed = False
+            llm_skipped = None
+            if use_rag:
+                llm_result = await analyzer.review_comments(file_content, units=units)
+                violations.extend(llm_result["violations"])
+                llm_failed = llm_result["status"] != "success"
+                llm_skipped = llm_result["skip_reason"]
+                if not llm_failed:
+                    llm_violations = llm_result["violations"]
+
+            result = analyzer._build_result(file_name, file_path, violations, llm_skipped=llm_skipped)
+            if use_rag:
+                analyzer.attach_guide_context(result, rule_plan)
+            if not llm_failed:
+                analyzer.result_cache.put(cache_key, result)
+            snapshot = AnalysisSnapshot(
+                content=file_content,
+                parsed=None,
+                rule_results=run.results,
+                block_comment_lines=run.block_comment_lines,
+                llm_violations=llm_violations
+            )
+            return result, snapshot
+        except Exception as e:
+            logger.error("Batch analysis failed for %s: %s", file_name, e)
+            return analyzer._error_result(file_name, file_path, e), None
+
+    async def _analyze_group(
+        self,
+        files: Dict[str, Dict],
+        leader_id: str,
+        followers: List[Tuple[str, float]],
+        style_guide: str,
+        use_rag: bool,
+        rule_plan: StyleGuideRulePlan
+    ) -> Dict[str, AnalysisResult]:
+        """Analyze a file, then its near-duplicates as revisions of it"""
+        result, snapshot = await self._analyze(files[leader_id], style_guide, use_rag, rule_plan)
+        results = {leader_id: result}
+
+        async def follow(file_id: str, score: float) -> AnalysisResult:
+            if snapshot is None or _streamed(files[file_id]):
+                return await self.analyze_file(files[file_id], style_guide, use_rag, rule_plan)
+            file_data = files[file_id]
+            followed, _ = await self.analyzer.analyze_revision(
+                file_data["content"], file_data["name"], file_data.get("path") or file_data["name"],
+                style_guide, use_rag, previous=snapshot, rule_plan=rule_plan
+            )
+            if followed.status == "success" and not followed.cached:
+                followed.reused_from = leader_id
+                followed.similarity = round(score, 3)
+            return followed
+
+        followed = await asyncio.gather(*[follow(file_id, score) for file_id, score in followers])
+        results.update(zip([file_id for file_id, _ in followers], followed))
+        return results
+
+    async def analyze_files(
+        self,
+        files: Dict[str, Dict],
+        style_guide: str,
+        use_rag: bool,
+        rule_plan: Optional[StyleGuideRulePlan] = None
+    ) -> BatchAnalysisResult:
+        """
+        Analyze every file concurrently
+
+        Args:
+            files: Uploaded file records keyed by file_id
+            style_guide: Style guide text applied to every file
+            rule_plan: The guide's compiled rule plan (compiled here if not given)
+            use_rag: Whether to run the LLM comment quality check
+
+        Returns:
+            Per-file results plus aggregate statistics
+        """
+        logger.info(
+            "Batch analysis: %d files, %d workers, %d concurrent LLM requests",
+            len(files), self.max_workers, self.analyzer.ollama_service.max_concurrency
+        )
+        if rule_plan is None:
+            rule_plan = self.analyzer.compile_rule_plan(style_guide)
+        file_ids = list(files.keys())
+        if near_duplicate_reuse():
+            assignment = await asyncio.to_thread(get_similarity_index().group, file_ids)
+        else:
+            assignment = {fid: None for fid in file_ids}
+        groups: Dict[str, List[Tuple[str, float]]] = {fid: [] for fid in file_ids if assignment[fid] is None}
+        for fid in file_ids:
+            if assignment[fid] is not None:
+                leader, score = assignment[fid]
+                groups[leader].append((fid, score))
+
+        grouped = await asyncio.gather(*[
+            self._analyze_group(files, leader, followers, style_guide, use_rag, rule_plan)
+            for leader, followers in groups.items()
+        ])
+        merged = {fid: result for group in grouped for fid, result in group.items()}
+        by_id = {fid: merged[fid] for fid in file_ids}
+        results = list(by_id.values())
+        summary = self._summarize(results)
+        logger.info(
+            "Batch done: %d analyzed, %d failed, %d from cache, %d from near-duplicates, %d violations",
+            summary.analyzed_files, summary.failed_files, summary.cached_files, summary.reused_files,
+            summary.total_violations
+        )
+        return BatchAnalysisResult(results=by_id, summary=summary)
+
+    def _summarize(self, results: List[AnalysisResult]) -> BatchAnalysisSummary:
+        by_severity: Dict[str, int] = {}
+        by_type: Dict[str, int] = {}
+        for result in results:
+            for key, count in result.violations_by_severity.items():
+                by_severity[key] = by_severity.get(key, 0) + count
+            for key, count in result.violations_by_type.items():
+                by_type[key] = by_type.get(key, 0) + count
+        failed = sum(1 for r in results if r.status != "success")
+        return BatchAnalysisSummary(
+            total_files=len(results),
+            analyzed_files=len(results) - failed,
+            failed_files=failed,
+            cached_files=sum(1 for r in results if r.cached),
+            reused_files=sum(1 for r in results if r.reused_from is not None),
+            total_violations=sum(r.total_violations for r in results),
+            violations_by_severity=by_severity,
+            violations_by_type=by_type
+        )
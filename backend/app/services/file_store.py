@@ -0,0 +1,324 @@
+"""
+On-disk storage for uploaded files and style guides
+
+Bodies live in a content-addressed blob store (one file per SHA-256, so
+identical uploads are stored once) and a small SQLite index maps upload IDs
+to their blob and metadata. Several server processes can share one store.
+"""
+import hashlib
+import json
+import os
+import sqlite3
+import tempfile
+import threading
+import time
+from typing import Any, Dict, Iterable, Iterator, List, MutableMapping, Optional, Tuple
+
+# Lines between entries of BlobLines' offset index
+LINE_INDEX_STRIDE = 1024
+
+
+class BlobStore:
+    """Immutable bodies stored as <root>/<first two hex digits>/<sha256>"""
+
+    def __init__(self, root: str):
+        self.root = root
+
+    def path(self, digest: str) -> str:
+        return os.path.join(self.root, digest[:2], digest)
+
+    def put(self, data: bytes) -> str:
+        """Store a body and return its digest; an existing identical body is reused"""
+        digest = hashlib.sha256(data).hexdigest()
+        target = self.path(digest)
+        if not os.path.exists(target):
+            os.makedirs(os.path.dirname(target), exist_ok=True)
+            # Write under a temporary name so readers never see a partial blob
+            fd, tmp = tempfile.mkstemp(dir=os.path.dirname(target), suffix=".tmp")
+            try:
+                with os.fdopen(fd, "wb") as out:
+                    out.write(data)
+                os.replace(tmp, target)
+            except BaseException:
+                if os.path.exists(tmp):
+                    os.unlink(tmp)
+                raise
+        return digest
+
+    def exists(self, digest: str) -> bool:
+        return os.path.exists(self.path(digest))
+
+    def read_text(self, digest: str) -> str:
+        with open(self.path(digest), "rb") as f:
+            return f.read().decode("utf-8")
+
+    def lines(self, digest: str) -> "BlobLines":
+        return BlobLines(self.path(digest))
+
+    def delete(self, digest: str) -> None:
+        try:
+            os.unlink(self.path(digest))
+        except FileNotFoundError:
+            pass
+
+
+class BlobLines:
+    """
+    Lines of a stored text body, read from disk without loading the whole body
+
+    Iterating yields the lines as content.split('\n') would, one at a time.
+    Each pass records the byte offset of every LINE_INDEX_STRIDE-th line, so
+    text(numbers) can afterwards seek close to any line instead of reading
+    the body from the start.
+    """
+
+    def __init__(self, path: str):
+        self.path = path
+        self.offsets: List[int] = [0]  # offsets[i]: start of line i * LINE_INDEX_STRIDE + 1
+
+    def __iter__(self) -> Iterator[str]:
+        with open(self.path, "rb") as f:
+            number, offset = 1, 0
+            raw = b"\n"
+            for raw in f:
+                if number - 1 == len(self.offsets) * LINE_INDEX_STRIDE:
+                    self.offsets.append(offset)
+                yield raw.rstrip(b"\n").decode("utf-8")
+                number += 1
+                offset += len(raw)
+            if raw.endswith(b"\n"):
+                # split('\n') ends with an empty line after a trailing newline (or for an empty body)
+                yield ""
+
+    def text(self, numbers: Iterable[int]) -> Dict[int, str]:
+        """Text of the given 1-based lines; lines past the last newline are left out"""
+        found: Dict[int, str] = {}
+        with open(self.path, "rb") as f:
+            number = 0  # line the file position is at (0: not positioned yet)
+            for wanted in sorted(set(numbers)):
+                if wanted < 1:
+                    continue
+                block = min((wanted - 1) // LINE_INDEX_STRIDE, len(self.offsets) - 1)
+                start = block * LINE_INDEX_STRIDE + 1
+                if not start <= number <= wanted:
+                    f.seek(self.offsets[block])
+                    number = start
+                raw = f.readline()
+                while raw and number < wanted:
+                    raw = f.readline()
+                    number += 1
+                if not raw:
+                    break
+                found[wanted] = raw.rstrip(b"\n").decode("utf-8")
+                number += 1
+        return found
+
+
+class StoredRecord(dict):
+    """
+    Metadata of a stored upload
+
+    The body is only read from the blob store the first time "content" is
+    accessed, so listing files never loads their contents.
+    """
+
+    def __init__(self, meta: Dict[str, Any], blob: str, blobs: BlobStore):
+        super().__init__(meta)
+        self.blob = blob
+        self._blobs = blobs
+
+    def __missing__(self, key):
+        if key != "content":
+            raise KeyError(key)
+        content = self._blobs.read_text(self.blob)
+        self["content"] = content
+        return content
+
+    def get(self, key, default=None):
+        if key == "content":
+            return self["content"]
+        return super().get(key, default)
+
+    def lines(self) -> BlobLines:
+        """The body's lines, read from the blob store without loading the content"""
+        return self._blobs.lines(self.blob)
+
+
+class FileStore:
+    """
+    SQLite index of uploads over a BlobStore
+
+    Records are grouped by kind ("files", "rag_documents"); the content of a
+    record goes to the blob store and every other field is kept as JSON
+    metadata in the index.
+    """
+
+    def __init__(self, path: Optional[str] = None):
+        rag_data_path = os.getenv("RAG_DATA_PATH", "./rag_data")
+        self.root = path or os.getenv("FILE_STORE_PATH", os.path.join(rag_data_path, "files"))
+        self.blobs = BlobStore(os.path.join(self.root, "blobs"))
+        self._lock = threading.Lock()
+        self._conn: Optional[sqlite3.Connection] = None
+
+    def _connection(self) -> sqlite3.Connection:
+        if self._conn is None:
+            os.makedirs(self.root, exist_ok=True)
+            # Autocommit mode; writes open their own IMMEDIATE transactions so
+            # blob reference counting is serialized across processes
+            conn = sqlite3.connect(
+                os.path.join(self.root, "index.sqlite3"), check_same_thread=False, isolation_level=None
+            )
+            conn.execute("PRAGMA journal_mode=WAL")
+            conn.execute("PRAGMA busy_timeout=5000")
+            conn.execute(
+                "CREATE TABLE IF NOT EXISTS records ("
+                " kind TEXT NOT NULL,"
+                " id TEXT NOT NULL,"
+                " blob TEXT NOT NULL,"
+                " meta_json TEXT NOT NULL,"
+                " created_at REAL NOT NULL,"
+                " PRIMARY KEY (kind, id))"
+            )
+            conn.execute("CREATE INDEX IF NOT EXISTS records_blob ON records (blob)")
+            self._conn = conn
+        return self._conn
+
+    def collection(self, kind: str) -> "RecordCollection":
+        return RecordCollection(self, kind)
+
+    def put(self, kind: str, record_id: str, record: Dict[str, Any]) -> None:
+        """Insert or replace a record; record["content"] is the body (str)"""
+        meta = {k: v for k, v in record.items() if k != "content"}
+        data = record["content"].encode("utf-8")
+        with self._lock:
+            conn = self._connection()
+            conn.execute("BEGIN IMMEDIATE")
+            try:
+                row = conn.execute(
+                    "SELECT blob FROM records WHERE kind = ? AND id = ?", (kind, record_id)
+                ).fetchone()
+                # Inside the write transaction, so no other process can release
+                # this blob between storing it and referencing it
+                digest = self.blobs.put(data)
+                # Updates keep created_at, so revisions do not reorder the listing
+                conn.execute(
+                    "INSERT INTO records (kind, id, blob, meta_json, created_at) VALUES (?, ?, ?, ?, ?)"
+                    " ON CONFLICT (kind, id) DO UPDATE SET blob = excluded.blob, meta_json = excluded.meta_json",
+                    (kind, record_id, digest, json.dumps(meta), time.time())
+                )
+                if row is not None and row[0] != digest:
+                    self._release(conn, row[0])
+                conn.execute("COMMIT")
+            except BaseException:
+                conn.execute("ROLLBACK")
+                raise
+
+    def get(self, kind: str, record_id: str) -> Optional[StoredRecord]:
+        with self._lock:
+            row = self._connection().execute(
+                "SELECT blob, meta_json FROM records WHERE kind = ? AND id = ?", (kind, record_id)
+            ).fetchone()
+        if row is None:
+            return None
+        return StoredRecord(json.loads(row[1]), row[0], self.blobs)
+
+    def contains(self, kind: str, record_id: str) -> bool:
+        with self._lock:
+            row = self._connection().execute(
+                "SELECT 1 FROM records WHERE kind = ? AND id = ?", (kind, record_id)
+            ).fetchone()
+        return row is not None
+
+    def delete(self, kind: str, record_id: str) -> bool:
+        """Remove a record, and its blob when nothing else references it"""
+        with self._lock:
+            conn = self._connection()
+            conn.execute("BEGIN IMMEDIATE")
+            try:
+                row = conn.execute(
+                    "SELECT blob FROM records WHERE kind = ? AND id = ?", (kind, record_id)
+                ).fetchone()
+                if row is not None:
+                    conn.execute("DELETE FROM records WHERE kind = ? AND id = ?", (kind, record_id))
+                    self._release(conn, row[0])
+                conn.execute("COMMIT")
+            except BaseException:
+                conn.execute("ROLLBACK")
+                raise
+        return row is not None
+
+    def _release(self, conn: sqlite3.Connection, digest: str) -> None:
+        remaining = conn.execute("SELECT COUNT(*) FROM records WHERE blob = ?", (digest,)).fetchone()[0]
+        if remaining == 0:
+            self.blobs.delete(digest)
+
+    def records(self, kind: str) -> Iterator[Tuple[str, StoredRecord]]:
+        """All records of a kind in upload order (metadata only until content is read)"""
+        with self._lock:
+            rows = self._connection().execute(
+                "SELECT id, blob, meta_json FROM records WHERE kind = ? ORDER BY created_at, id", (kind,)
+            ).fetchall()
+        for record_id, blob, meta_json in rows:
+            yield record_id, StoredRecord(json.loads(meta_json), blob, self.blobs)
+
+    def count(self, kind: str) -> int:
+        with self._lock:
+            return self._connection().execute(
+                "SELECT COUNT(*) FROM records WHERE kind = ?", (kind,)
+            ).fetchone()[0]
+
+
+class RecordCollection(MutableMapping):
+    """
+    Dict-like view of one kind of record in a FileStore
+
+    Records read from the collection are snapshots: changing one does not
+    write it back, so updates must assign the whole record again.
+    """
+
+    def __init__(self, store: FileStore, kind: str):
+        self.store = store
+        self.kind = kind
+
+    def __getitem__(self, record_id: str) -> StoredRecord:
+        record = self.store.get(self.kind, record_id)
+        if record is None:
+            raise KeyError(record_id)
+        return record
+
+    def get(self, record_id: str, default=None):
+        record = self.store.get(self.kind, record_id)
+        return default if record is None else record
+
+    def __setitem__(self, record_id: str, record: Dict[str, Any]) -> None:
+        self.store.put(self.kind, record_id, record)
+
+    def __delitem__(self, record_id: str) -> None:
+        if not self.store.delete(self.kind, record_id):
+            raise KeyError(record_id)
+
+    def __contains__(self, record_id) -> bool:
+        return self.store.contains(self.kind, record_id)
+
+    def __iter__(self):
+        return (record_id for record_id, _ in self.store.records(self.kind))
+
+    def __len__(self) -> int:
+        return self.store.count(self.kind)
+
+    def items(self):
+        return list(self.store.records(self.kind))
+
+
+_store: Optional[FileStore] = None
+_store_lock = threading.Lock()
+
+
+def get_file_store() -> FileStore:
+    """Process-wide FileStore"""
+    global _store
+    if _store is None:
+        with _store_lock:
+            if _store is None:
+                _store = FileStore()
+    return _store
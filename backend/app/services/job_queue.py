@@ -0,0 +1,156 @@
+"""
+Background job queue for long-running analyses
+
+Jobs run in the process that queued them; their status and result are
+also written to the shared JobStore, so any server process can answer
+/status and /results for them.
+"""
+import asyncio
+import logging
+import os
+import uuid
+from collections import OrderedDict
+from datetime import datetime
+from typing import Awaitable, Callable, List, Optional
+from app.models.core import AnalysisJobStatus, AnalysisResult
+from app.services.job_store import JobStore, get_job_store
+
+logger = logging.getLogger(__name__)
+
+JOB_KIND = "analysis"
+
+# A job receives a progress callback (called with a stage name) and returns the result
+JobFunc = Callable[[Callable[[str], None]], Awaitable[AnalysisResult]]
+
+
+class AnalysisJob:
+    """A queued analysis with its progress and, once finished, its result"""
+
+    def __init__(self, file_id: str, stages: List[str], func: Optional[JobFunc], store: Optional[JobStore] = None):
+        self.status = AnalysisJobStatus(
+            analysis_id=str(uuid.uuid4()),
+            file_id=file_id,
+            status="queued",
+            stages=list(stages)
+        )
+        self.func = func
+        self.result: Optional[AnalysisResult] = None
+        self.store = store
+
+    @classmethod
+    def stored(cls, status_json: str, result_json: Optional[str]) -> "AnalysisJob":
+        """A job of another process, as last written to the JobStore (it cannot be run)"""
+        job = cls.__new__(cls)
+        job.status = AnalysisJobStatus.model_validate_json(status_json)
+        job.result = AnalysisResult.model_validate_json(result_json) if result_json else None
+        job.func = None
+        job.store = None
+        return job
+
+    @property
+    def id(self) -> str:
+        return self.status.analysis_id
+
+    def save(self) -> None:
+        if self.store is not None:
+            self.store.put(JOB_KIND, self.id, self.status.status, self.status, self.result)
+
+    def enter_stage(self, stage: str) -> None:
+        status = self.status
+        if status.stage and status.stage not in status.stages_completed:
+            status.stages_completed.append(status.stage)
+        status.stage = stage
+        status.progress = len(status.stages_completed) / max(len(status.stages), 1)
+        status.updated_at = datetime.utcnow()
+        self.save()
+
+    def finish(self, result: Optional[AnalysisResult], error: Optional[str] = None) -> None:
+        status = self.status
+        self.result = result
+        status.updated_at = datetime.utcnow()
+        status.stage = None
+        if error is None:
+            status.status = "completed"
+            status.stages_completed = list(status.stages)
+            status.progress = 1.0
+        else:
+            status.status = "failed"
+            status.error_message = error
+        self.save()
+
+
+class AnalysisJobQueue:
+    """
+    In-process queue drained by a fixed number of worker tasks
+
+    ANALYSIS_JOB_WORKERS bounds how many analyses run at once in this
+    process; finished jobs are kept for lookup until ANALYSIS_JOB_RETENTION
+    newer jobs have been submitted. Jobs of other processes are looked up
+    in the JobStore.
+    """
+
+    def __init__(self, store: Optional[JobStore] = None):
+        self.worker_count = max(1, int(os.getenv("ANALYSIS_JOB_WORKERS", "2")))
+        self.retention = max(1, int(os.getenv("ANALYSIS_JOB_RETENTION", "500")))
+        self.store = store or get_job_store()
+        self.jobs: "OrderedDict[str, AnalysisJob]" = OrderedDict()
+        self._queue: Optional[asyncio.Queue] = None
+        self._workers: List[asyncio.Task] = []
+
+    def _ensure_workers(self) -> asyncio.Queue:
+        # Started on first use so the queue and tasks bind to the running loop
+        if self._queue is None:
+            self._queue = asyncio.Queue()
+            self._workers = [asyncio.create_task(self._worker()) for _ in range(self.worker_count)]
+        return self._queue
+
+    async def _worker(self) -> None:
+        while True:
+            job: AnalysisJob = await self._queue.get()
+            try:
+                job.status.status = "running"
+                job.save()
+                result = await job.func(job.enter_stage)
+                if result.status == "success":
+                    job.finish(result)
+                else:
+                    job.finish(result, result.error_message or "Analysis failed")
+            except Exception as e:
+                logger.error("Analysis job %s failed: %s", job.id, e)
+                job.finish(None, str(e))
+            finally:
+                self._queue.task_done()
+
+    def submit(self, file_id: str, stages: List[str], func: JobFunc) -> AnalysisJob:
+        """Queue an analysis; returns the job whose id is used with get()"""
+        queue = self._ensure_workers()
+        job = AnalysisJob(file_id, stages, func, self.store)
+        self.jobs[job.id] = job
+        job.save()
+        self._evict()
+        queue.put_nowait(job)
+        return job
+
+    def get(self, analysis_id: str) -> Optional[AnalysisJob]:
+        job = self.jobs.get(analysis_id)
+        if job is None:
+            stored = self.store.get(JOB_KIND, analysis_id)
+            if stored is not None:
+                job = AnalysisJob.stored(*stored)
+        return job
+
+    def _evict(self) -> None:
+        """Drop the oldest finished jobs beyond the retention limit (here and in the store)"""
+        self.store.prune(JOB_KIND, self.retention)
+        excess = len(self.jobs) - self.retention
+        if excess <= 0:
+            return
+        for job_id in [jid for jid, job in self.jobs.items() if job.status.status in ("completed", "failed")][:excess]:
+            del self.jobs[job_id]
+
+    async def shutdown(self) -> None:
+        for task in self._workers:
+            task.cancel()
+        await asyncio.gather(*self._workers, return_exceptions=True)
+        self._workers = []
+        self._queue = None
@@ -0,0 +1,194 @@
+"""
+Job statuses and results shared by all server processes
+
+Background analyses and bulk RAG ingestions run in the process that
+accepted them, but with several workers (run.py WORKERS) the request that
+polls for a job may land on any of them. Every status change, and the
+result once a job finishes, is therefore written to a small SQLite table
+that all processes read.
+
+Each row records the process that owns it and when it last wrote it. A
+queued or running job whose process has exited can never finish: it is
+marked failed when it is read, when the store is opened and before
+pruning, so it stops showing as running and is pruned like any finished
+job. Whether the owner is still running is checked for processes of this
+machine; other jobs count as abandoned once they have not been written
+for JOB_STALE_SECONDS.
+"""
+import json
+import logging
+import os
+import socket
+import sqlite3
+import threading
+import time
+from datetime import datetime
+from typing import Optional, Tuple
+from pydantic import BaseModel
+
+logger = logging.getLogger(__name__)
+
+FINISHED_STATES = ("completed", "failed")
+STALE_ERROR = "Job was abandoned: the server process running it stopped"
+
+
+def _process_alive(pid: int) -> Optional[bool]:
+    """Whether a process of this machine is running, or None if that cannot be checked"""
+    if os.name == "nt":
+        # os.kill would terminate the process there
+        return None
+    try:
+        os.kill(pid, 0)
+    except ProcessLookupError:
+        return False
+    except PermissionError:
+        pass
+    return True
+
+
+class JobStore:
+    """SQLite table of (kind, job id) -> status JSON and result JSON, with the owning process"""
+
+    def __init__(self, path: Optional[str] = None):
+        rag_data_path = os.getenv("RAG_DATA_PATH", "./rag_data")
+        self.path = path or os.getenv("JOB_STORE_PATH", os.path.join(rag_data_path, "jobs.sqlite3"))
+        self.stale_seconds = max(1.0, float(os.getenv("JOB_STALE_SECONDS", "3600")))
+        self.host = socket.gethostname()
+        self.owner = f"{self.host}:{os.getpid()}"
+        self._lock = threading.Lock()
+        self._conn: Optional[sqlite3.Connection] = None
+
+    def _connection(self) -> sqlite3.Connection:
+        if self._conn is None:
+            os.makedirs(os.path.dirname(os.path.abspath(self.path)), exist_ok=True)
+            conn = sqlite3.connect(self.path, check_same_thread=False)
+            conn.execute("PRAGMA journal_mode=WAL")
+            conn.execute("PRAGMA busy_timeout=5000")
+            conn.execute(
+                "CREATE TABLE IF NOT EXISTS jobs ("
+                " kind TEXT NOT NULL,"
+                " id TEXT NOT NULL,"
+                " state TEXT NOT NULL,"
+                " status_json TEXT NOT NULL,"
+                " result_json TEXT,"
+                " created_at REAL NOT NULL,"
+                " owner TEXT,"
+                " updated_at REAL,"
+                " PRIMARY KEY (kind, id))"
+            )
+            # Stores written before owner and updated_at existed
+            columns = {row[1] for row in conn.execute("PRAGMA table_info(jobs)")}
+            if "owner" not in columns:
+                conn.execute("ALTER TABLE jobs ADD COLUMN owner TEXT")
+            if "updated_at" not in columns:
+                conn.execute("ALTER TABLE jobs ADD COLUMN updated_at REAL")
+                conn.execute("UPDATE jobs SET updated_at = created_at")
+            conn.execute("CREATE INDEX IF NOT EXISTS jobs_created ON jobs (kind, created_at)")
+            conn.commit()
+            # Unfinished rows under this owner are left by an earlier process with the same pid
+            self._expire_stale(conn, restarted=True)
+            self._conn = conn
+        return self._conn
+
+    def _is_stale(self, owner: Optional[str], updated_at: Optional[float], restarted: bool = False) -> bool:
+        """Whether an unfinished job can no longer be finished by its owner"""
+        host, _, pid = (owner or "").rpartition(":")
+        if host == self.host and pid.isdigit():
+            alive = (not restarted) if owner == self.owner else _process_alive(int(pid))
+            if alive is not None:
+                return not alive
+        # Another machine's process (or an unknown one): only the age of the last write tells
+        return updated_at is None or time.time() - updated_at > self.stale_seconds
+
+    def _expire_stale(self, conn: sqlite3.Connection, kind: Optional[str] = None,
+                      job_id: Optional[str] = None, restarted: bool = False) -> None:
+        """Mark the stale queued/running jobs failed (all, one kind's, or one job)"""
+        query = "SELECT kind, id, status_json, owner, updated_at FROM jobs WHERE state NOT IN (?, ?)"
+        params: list = list(FINISHED_STATES)
+        if kind is not None:
+            query += " AND kind = ?"
+            params.append(kind)
+        if job_id is not None:
+            query += " AND id = ?"
+            params.append(job_id)
+        stale = [row for row in conn.execute(query, params) if self._is_stale(row[3], row[4], restarted)]
+        if not stale:
+            return
+        now = time.time()
+        with conn:
+            for row_kind, row_id, status_json, _, updated_at in stale:
+                status = json.loads(status_json)
+                status.update(status="failed", error_message=STALE_ERROR,
+                              updated_at=datetime.utcfromtimestamp(now).isoformat())
+                if "stage" in status:
+                    status["stage"] = None
+                # Unless the owner wrote the row in the meantime
+                conn.execute(
+                    "UPDATE jobs SET state = 'failed', status_json = ?, updated_at = ?"
+                    " WHERE kind = ? AND id = ? AND updated_at IS ?",
+                    (json.dumps(status), now, row_kind, row_id, updated_at)
+                )
+        logger.warning("Marked %d abandoned job(s) failed", len(stale))
+
+    def put(self, kind: str, job_id: str, state: str, status: BaseModel,
+            result: Optional[BaseModel] = None) -> None:
+        """Insert or update a job; the stored result is kept when `result` is None"""
+        try:
+            with self._lock:
+                conn = self._connection()
+                with conn:
+                    now = time.time()
+                    conn.execute(
+                        "INSERT INTO jobs (kind, id, state, status_json, result_json, created_at, owner, updated_at)"
+                        " VALUES (?, ?, ?, ?, ?, ?, ?, ?)"
+                        " ON CONFLICT (kind, id) DO UPDATE SET state = excluded.state,"
+                        " status_json = excluded.status_json,"
+                        " result_json = COALESCE(excluded.result_json, jobs.result_json),"
+                        " owner = excluded.owner, updated_at = excluded.updated_at",
+                        (kind, job_id, state, status.model_dump_json(),
+                         result.model_dump_json() if result is not None else None, now, self.owner, now)
+                    )
+        except Exception as e:
+            logger.warning("Job store write failed for %s %s: %s", kind, job_id, e)
+
+    def get(self, kind: str, job_id: str) -> Optional[Tuple[str, Optional[str]]]:
+        """(status JSON, result JSON or None) of a job, or None if unknown; abandoned jobs read as failed"""
+        try:
+            with self._lock:
+                conn = self._connection()
+                self._expire_stale(conn, kind, job_id)
+                return conn.execute(
+                    "SELECT status_json, result_json FROM jobs WHERE kind = ? AND id = ?", (kind, job_id)
+                ).fetchone()
+        except Exception as e:
+            logger.warning("Job store read failed for %s %s: %s", kind, job_id, e)
+            return None
+
+    def prune(self, kind: str, keep: int) -> None:
+        """Delete finished (or abandoned) jobs of a kind beyond the `keep` most recent jobs"""
+        try:
+            with self._lock:
+                conn = self._connection()
+                self._expire_stale(conn, kind)
+                with conn:
+                    conn.execute(
+                        "DELETE FROM jobs WHERE kind = ? AND state IN (?, ?) AND id NOT IN"
+                        " (SELECT id FROM jobs WHERE kind = ? ORDER BY created_at DESC LIMIT ?)",
+                        (kind, *FINISHED_STATES, kind, keep)
+                    )
+        except Exception as e:
+            logger.warning("Job store prune failed for %s: %s", kind, e)
+
+
+_store: Optional[JobStore] = None
+_store_lock = threading.Lock()
+
+
+def get_job_store() -> JobStore:
+    """Process-wide JobStore"""
+    global _store
+    if _store is None:
+        with _store_lock:
+            if _store is None:
+                _store = JobStore()
+    return _store
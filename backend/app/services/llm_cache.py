@@ -0,0 +1,106 @@
+"""
+Persistent cache of LLM responses keyed by normalized code unit
+"""
+import hashlib
+import json
+import logging
+import os
+import re
+import sqlite3
+import threading
+import time
+from typing import Any, Dict, List, Optional
+
+logger = logging.getLogger(__name__)
+
+_WHITESPACE = re.compile(r'\s+')
+
+
+def normalize_code(text: str) -> str:
+    """
+    Whitespace-normalized form of a code unit
+
+    Runs of whitespace collapse to one space and lines are stripped, but the
+    line structure is kept so cached line offsets stay valid. Identifiers are
+    left alone: the comments being judged often describe them by name.
+    """
+    return '\n'.join(_WHITESPACE.sub(' ', line).strip() for line in text.split('\n'))
+
+
+class LLMResponseCache:
+    """
+    SQLite-backed cache of parsed LLM findings per code unit
+
+    Starter code, provided helpers and boilerplate main() repeat across
+    submissions, so a unit that has been judged once is not sent to Ollama
+    again. Keys cover the normalized unit text, the prompt template version
+    and the model with its options; findings are stored with line numbers
+    relative to the start of the unit.
+    """
+
+    def __init__(self, path: Optional[str] = None):
+        rag_data_path = os.getenv("RAG_DATA_PATH", "./rag_data")
+        self.path = path or os.getenv("LLM_CACHE_PATH", os.path.join(rag_data_path, "llm_cache.sqlite3"))
+        self.enabled = os.getenv("LLM_CACHE_ENABLED", "true").lower() != "false"
+        self._lock = threading.Lock()
+        self._conn: Optional[sqlite3.Connection] = None
+
+    def _connection(self) -> sqlite3.Connection:
+        if self._conn is None:
+            os.makedirs(os.path.dirname(os.path.abspath(self.path)), exist_ok=True)
+            conn = sqlite3.connect(self.path, check_same_thread=False)
+            conn.execute("PRAGMA journal_mode=WAL")
+            conn.execute(
+                "CREATE TABLE IF NOT EXISTS llm_responses ("
+                " cache_key TEXT PRIMARY KEY,"
+                " response_json TEXT NOT NULL,"
+                " created_at REAL NOT NULL)"
+            )
+            conn.commit()
+            self._conn = conn
+        return self._conn
+
+    def make_key(self, unit_text: str, prompt_version: str, model: str, options: Dict[str, Any]) -> str:
+        base = json.dumps({
+            "code": hashlib.sha256(normalize_code(unit_text).encode("utf-8")).hexdigest(),
+            "prompt": prompt_version,
+            "model": model,
+            "options": options
+        }, sort_keys=True)
+        return hashlib.sha256(base.encode("utf-8")).hexdigest()
+
+    def get(self, key: str) -> Optional[List[Dict[str, Any]]]:
+        """Return the cached findings for key, or None on a miss"""
+        if not self.enabled:
+            return None
+        try:
+            with self._lock:
+                row = self._connection().execute(
+                    "SELECT response_json FROM llm_responses WHERE cache_key = ?", (key,)
+                ).fetchone()
+            return json.loads(row[0]) if row is not None else None
+        except Exception as e:
+            logger.warning("LLM cache read failed: %s", e)
+            return None
+
+    def put(self, key: str, findings: List[Dict[str, Any]]) -> None:
+        if not self.enabled:
+            return
+        try:
+            with self._lock:
+                conn = self._connection()
+                conn.execute(
+                    "INSERT OR REPLACE INTO llm_responses (cache_key, response_json, created_at) VALUES (?, ?, ?)",
+                    (key, json.dumps(findings), time.time())
+                )
+                conn.commit()
+        except Exception as e:
+            logger.warning("LLM cache write failed: %s", e)
+
+    def clear(self) -> None:
+        if not self.enabled:
+            return
+        with self._lock:
+            conn = self._connection()
+            conn.execute("DELETE FROM llm_responses")
+            conn.commit()
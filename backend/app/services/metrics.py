@@ -0,0 +1,147 @@
+"""
+Per-stage latency metrics
+
+Timings are aggregated into process-wide histograms (exposed in the
+Prometheus text format at /metrics) and, while collect_timings() is active,
+also summed per stage for the analysis that is running.
+"""
+import threading
+import time
+from contextlib import contextmanager
+from contextvars import ContextVar
+from typing import Dict, Iterator, List, Optional, Tuple
+
+# Seconds; covers single rules (sub-millisecond) up to slow LLM calls
+DEFAULT_BUCKETS = (0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0, 60.0, 120.0)
+
+_current_timings: ContextVar[Optional[Dict[str, float]]] = ContextVar("analysis_timings", default=None)
+
+
+class Histogram:
+    """Cumulative-bucket histogram of observed durations"""
+
+    def __init__(self, buckets: Tuple[float, ...] = DEFAULT_BUCKETS):
+        self.buckets = buckets
+        self.counts = [0] * len(buckets)
+        self.total = 0.0
+        self.count = 0
+
+    def observe(self, value: float) -> None:
+        for i, bound in enumerate(self.buckets):
+            if value <= bound:
+                self.counts[i] += 1
+                break
+        self.total += value
+        self.count += 1
+
+
+class MetricsRegistry:
+    """Histograms and counters keyed by metric name and label set"""
+
+    def __init__(self):
+        self._lock = threading.Lock()
+        self._histograms: Dict[Tuple[str, Tuple[Tuple[str, str], ...]], Histogram] = {}
+        self._counters: Dict[Tuple[str, Tuple[Tuple[str, str], ...]], float] = {}
+        self._help: Dict[str, str] = {}
+
+    def describe(self, name: str, help_text: str) -> None:
+        self._help[name] = help_text
+
+    def observe(self, name: str, value: float, **labels: str) -> None:
+        key = (name, tuple(sorted(labels.items())))
+        with self._lock:
+            histogram = self._histograms.get(key)
+            if histogram is None:
+                histogram = self._histograms[key] = Histogram()
+            histogram.observe(value)
+
+    def increment(self, name: str, value: float = 1.0, **labels: str) -> None:
+        key = (name, tuple(sorted(labels.items())))
+        with self._lock:
+            self._counters[key] = self._counters.get(key, 0.0) + value
+
+    def render(self) -> str:
+        """All histograms in the Prometheus text exposition format"""
+        lines: List[str] = []
+        with self._lock:
+            items = sorted(self._histograms.items())
+            described = set()
+            for (name, labels), histogram in items:
+                if name not in described:
+                    described.add(name)
+                    if name in self._help:
+                        lines.append(f"# HELP {name} {self._help[name]}")
+                    lines.append(f"# TYPE {name} histogram")
+                label_text = ",".join(f'{k}="{v}"' for k, v in labels)
+                prefix = label_text + "," if label_text else ""
+                cumulative = 0
+                for bound, count in zip(histogram.buckets, histogram.counts):
+                    cumulative += count
+                    lines.append(f'{name}_bucket{{{prefix}le="{bound}"}} {cumulative}')
+                lines.append(f'{name}_bucket{{{prefix}le="+Inf"}} {histogram.count}')
+                suffix = "{" + label_text + "}" if label_text else ""
+                lines.append(f"{name}_sum{suffix} {histogram.total}")
+                lines.append(f"{name}_count{suffix} {histogram.count}")
+            for (name, labels), value in sorted(self._counters.items()):
+                if name not in described:
+                    described.add(name)
+                    if name in self._help:
+                        lines.append(f"# HELP {name} {self._help[name]}")
+                    lines.append(f"# TYPE {name} counter")
+                label_text = ",".join(f'{k}="{v}"' for k, v in labels)
+                suffix = "{" + label_text + "}" if label_text else ""
+                lines.append(f"{name}{suffix} {value}")
+        return "\n".join(lines) + "\n"
+
+    def reset(self) -> None:
+        with self._lock:
+            self._histograms.clear()
+            self._counters.clear()
+
+
+metrics = MetricsRegistry()
+metrics.describe("grader_stage_seconds", "Time spent per analysis stage")
+metrics.describe("grader_rule_seconds", "Time spent per rule during one file scan")
+
+
+def record_stage(stage: str, seconds: float) -> None:
+    """Record a stage duration in the histograms and in the active timings, if any"""
+    metrics.observe("grader_stage_seconds", seconds, stage=stage)
+    timings = _current_timings.get()
+    if timings is not None:
+        timings[stage] = timings.get(stage, 0.0) + seconds
+
+
+def record_rule(rule: str, seconds: float) -> None:
+    metrics.observe("grader_rule_seconds", seconds, rule=rule)
+    timings = _current_timings.get()
+    if timings is not None:
+        key = f"rule.{rule}"
+        timings[key] = timings.get(key, 0.0) + seconds
+
+
+@contextmanager
+def timed(stage: str) -> Iterator[None]:
+    """Time the enclosed block as `stage`"""
+    start = time.perf_counter()
+    try:
+        yield
+    finally:
+        record_stage(stage, time.perf_counter() - start)
+
+
+@contextmanager
+def collect_timings() -> Iterator[Dict[str, float]]:
+    """
+    Sum the stage timings recorded in this context into a dict
+
+    Tasks and threads started inside the block inherit the context, so
+    concurrent LLM batches add to the same dict (their times may therefore
+    exceed the wall-clock time of the stage).
+    """
+    timings: Dict[str, float] = {}
+    token = _current_timings.set(timings)
+    try:
+        yield timings
+    finally:
+        _current_timings.reset(token)
@@ -0,0 +1,170 @@
+"""
+Pool of Ollama endpoints for the LLM checks
+
+OLLAMA_HOSTS lists the endpoints as comma-separated URLs, each optionally
+followed by "=N" for its own limit on requests in flight, e.g.
+
+    OLLAMA_HOSTS=http://gpu1:11434=4,http://gpu2:11434
+
+Hosts without a limit use LLM_CONCURRENCY. Without OLLAMA_HOSTS the pool
+is a single OLLAMA_HOST endpoint, as before.
+
+Each request goes to the healthy host with the fewest requests in flight
+relative to its limit. A host whose request fails is taken out of rotation
+for OLLAMA_HOST_COOLDOWN seconds and then tried again with real traffic;
+explicit health checks (OllamaService.check_hosts) bring it back sooner.
+When every host is down, requests still go to the least loaded one so a
+lone host behaves as it did without the pool.
+"""
+import asyncio
+import logging
+import os
+import time
+from contextlib import asynccontextmanager
+from typing import AsyncIterator, Dict, List, Optional, Set
+import ollama
+
+logger = logging.getLogger(__name__)
+
+
+def host_cooldown() -> float:
+    return float(os.getenv("OLLAMA_HOST_COOLDOWN", "30"))
+
+
+class OllamaHost:
+    """One Ollama endpoint and its routing state"""
+
+    def __init__(self, url: str, max_concurrency: int):
+        self.url = url
+        self.max_concurrency = max(1, max_concurrency)
+        # Async client so a long generation does not block the event loop
+        self.client = ollama.AsyncClient(host=url)
+        self.in_flight = 0
+        self.healthy = True
+        self.retry_at = 0.0  # when an unhealthy host may be tried again
+        self.failures = 0  # consecutive
+        self.completed = 0
+
+    def available(self, now: float) -> bool:
+        return self.healthy or now >= self.retry_at
+
+    def load(self) -> float:
+        return self.in_flight / self.max_concurrency
+
+    def status(self) -> Dict:
+        return {
+            "url": self.url,
+            "healthy": self.healthy,
+            "in_flight": self.in_flight,
+            "max_concurrency": self.max_concurrency,
+            "completed": self.completed,
+            "consecutive_failures": self.failures,
+        }
+
+
+def parse_hosts(spec: str, default_concurrency: int) -> List[OllamaHost]:
+    hosts = []
+    for entry in spec.split(","):
+        entry = entry.strip()
+        if not entry:
+            continue
+        url, concurrency = entry, default_concurrency
+        head, sep, limit = entry.rpartition("=")
+        if sep:
+            try:
+                url, concurrency = head.strip(), int(limit)
+            except ValueError:
+                logger.warning("Ignoring bad concurrency in OLLAMA_HOSTS entry %r", entry)
+        hosts.append(OllamaHost(url, concurrency))
+    return hosts
+
+
+class OllamaPool:
+    """Least-outstanding-requests routing over OllamaHosts, with per-host caps"""
+
+    def __init__(self, hosts: List[OllamaHost]):
+        if not hosts:
+            raise ValueError("OllamaPool needs at least one host")
+        self.hosts = hosts
+        self._condition: Optional[asyncio.Condition] = None
+
+    @classmethod
+    def from_env(cls) -> "OllamaPool":
+        default_concurrency = max(1, int(os.getenv("LLM_CONCURRENCY", "2")))
+        hosts = parse_hosts(os.getenv("OLLAMA_HOSTS", ""), default_concurrency)
+        if not hosts:
+            hosts = [OllamaHost(os.getenv("OLLAMA_HOST", "http://localhost:11434"), default_concurrency)]
+        return cls(hosts)
+
+    @property
+    def max_concurrency(self) -> int:
+        """Requests the whole pool serves at once"""
+        return sum(host.max_concurrency for host in self.hosts)
+
+    def _wakeup(self) -> asyncio.Condition:
+        # Created lazily so it binds to the running event loop
+        if self._condition is None:
+            self._condition = asyncio.Condition()
+        return self._condition
+
+    def _pick(self, exclude: Set[str]) -> Optional[OllamaHost]:
+        """Least loaded host with a free slot, preferring healthy ones; None if all are busy"""
+        now = time.monotonic()
+        candidates = [h for h in self.hosts if h.url not in exclude] or self.hosts
+        free = [h for h in candidates if h.in_flight < h.max_concurrency]
+        usable = [h for h in free if h.available(now)]
+        if not usable and not any(h.available(now) for h in candidates):
+            # Everything is down: keep trying rather than failing without a request
+            usable = free
+        if not usable:
+            return None
+        return min(usable, key=lambda h: (h.load(), h.in_flight))
+
+    @asynccontextmanager
+    async def acquire(self, exclude: Optional[Set[str]] = None) -> AsyncIterator[OllamaHost]:
+        """
+        Hold a request slot on the best host, waiting while all are at their limit
+
+        `exclude` names hosts already tried for this request; they are only
+        used again when no other host exists.
+        """
+        exclude = exclude or set()
+        condition = self._wakeup()
+        async with condition:
+            host = self._pick(exclude)
+            while host is None:
+                await condition.wait()
+                host = self._pick(exclude)
+            host.in_flight += 1
+        try:
+            yield host
+        finally:
+            async with condition:
+                host.in_flight -= 1
+                condition.notify_all()
+
+    def mark_success(self, host: OllamaHost) -> None:
+        if not host.healthy:
+            logger.info("Ollama host %s is back in rotation", host.url)
+        host.healthy = True
+        host.failures = 0
+        host.completed += 1
+
+    def mark_failure(self, host: OllamaHost, error: Optional[BaseException] = None) -> None:
+        host.failures += 1
+        host.retry_at = time.monotonic() + host_cooldown()
+        if host.healthy:
+            logger.warning("Ollama host %s failed (%s); out of rotation for %.0fs",
+                           host.url, error, host_cooldown())
+        host.healthy = False
+
+    def set_health(self, host: OllamaHost, healthy: bool) -> None:
+        """Record an explicit health check"""
+        if healthy:
+            host.healthy = True
+            host.failures = 0
+        else:
+            self.mark_failure(host, RuntimeError("health check failed"))
+
+    def status(self) -> List[Dict]:
+        return [host.status() for host in self.hosts]
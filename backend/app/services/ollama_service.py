@@ -1,38 +1,249 @@
 """
 Ollama LLM integration service for C++ code analysis
 """
+import asyncio
+import logging
 import os
 import json
-from typing import Optional, Dict, Any, List
+import threading
+from typing import Any, Awaitable, Callable, Dict, List, Optional, Set, TypeVar, Union
 import ollama
+from app.services.llm_cache import LLMResponseCache
+from app.services.metrics import record_stage, timed
+from app.services.ollama_pool import OllamaHost, OllamaPool
+
+logger = logging.getLogger(__name__)
+
+# Bump whenever the comment quality prompt changes so cached reviews are not reused
+COMMENT_PROMPT_VERSION = "2"
+
+# Instruction prefixes. They are sent first and never vary with the file,
+# so consecutive requests share a prompt prefix that Ollama keeps evaluated
+# in its KV cache while the model stays loaded (see OLLAMA_KEEP_ALIVE).
+COMMENT_QUALITY_INSTRUCTIONS = """You are checking comment quality in C++ code. This is a SIMPLE task.
+
+The user sends C++ code with line numbers (the number before the | symbol).
+
+TASK: Find comments that are NOT descriptive or useful.
+
+ONLY report comments that are:
+1. Too vague (e.g., "// x" or "// temp")
+2. Completely unhelpful (e.g., "// code" or "// function")
+3. Obvious/redundant (e.g., "// increment i" for i++)
+
+DO NOT report:
+- Missing comments (handled separately)
+- Code issues (only check comments)
+
+If ALL comments are adequately descriptive, return: []
+
+OUTPUT FORMAT (JSON array only, no other text):
+[
+  {
+    "type": "poor_comment_quality",
+    "severity": "MINOR",
+    "line_number": 5,
+    "description": "Comment is too vague",
+    "rule_reference": "Code Documentation"
+  }
+]
+
+Only return valid JSON. If no issues, return: []"""
+
+ANALYSIS_INSTRUCTIONS = """You are a C++ semantic code analyzer. Analyze ONLY the user's code, which the user sends with line numbers.
+
+TASK: Find semantic and logic issues in the CODE TO ANALYZE section.
+
+WHAT TO LOOK FOR:
+- Memory leaks: new/malloc without delete/free
+- Wrong delete: delete[] vs delete mismatch
+- Naming: camelCase for functions, PascalCase for classes
+- Magic numbers: hardcoded values like 18, 500, 1.15
+- NULL vs nullptr
+- Missing switch default
+- Variable shadowing
+- Deep nesting (>3 levels)
+- Long functions (>50 lines)
+- Uninitialized variables
+
+DO NOT REPORT:
+- Formatting (tabs/spaces/braces/line length)
+- Missing comments (handled separately)
+
+CRITICAL: Before reporting a violation, verify:
+1. The violation exists in the CODE TO ANALYZE section (NOT the rules section)
+2. The line number is correct (use numbers before the | symbol)
+3. The code on that line actually has the issue you're reporting
+
+OUTPUT FORMAT (JSON array only, no other text):
+[
+  {
+    "type": "memory_leak",
+    "severity": "CRITICAL",
+    "line_number": 5,
+    "description": "new int[100] without delete[]",
+    "rule_reference": "Memory Management"
+  }
+]
+
+If NO violations found, return: []
+
+Only return valid JSON. No explanations, no markdown, just the JSON array.
+"""
+
+T = TypeVar("T")
+
+
+def number_lines(code: str) -> str:
+    """Prefix each line with its 1-based number, as the prompts expect"""
+    return '\n'.join(f"{i:4d} | {line}" for i, line in enumerate(code.split('\n'), 1))
+
+
+def keep_alive_setting() -> Union[float, str]:
+    """OLLAMA_KEEP_ALIVE as Ollama expects it: a duration ("30m") or seconds (-1 = forever)"""
+    value = os.getenv("OLLAMA_KEEP_ALIVE", "30m").strip()
+    try:
+        return float(value)
+    except ValueError:
+        return value
+
+
+def record_llm_usage(response: Any) -> None:
+    """
+    Record Ollama's own timings for a finished request
+
+    llm_prompt_eval is the time spent evaluating prompt tokens that were not
+    already in the KV cache, so it shows how much of the prefix was reused.
+    """
+    try:
+        prompt_eval = response.get('prompt_eval_duration')
+        generate = response.get('eval_duration')
+    except Exception:
+        return
+    if prompt_eval:
+        record_stage("llm_prompt_eval", prompt_eval / 1e9)  # reported in nanoseconds
+    if generate:
+        record_stage("llm_generate", generate / 1e9)
+
+
+def _host_fault(error: Exception) -> bool:
+    """Whether a failed request says something about the host rather than the request"""
+    status = getattr(error, "status_code", None)
+    if isinstance(status, int) and 400 <= status < 500 and status != 404:
+        return False
+    return True
 
 
 class OllamaService:
     """Service for interacting with Ollama and CodeLlama"""
 
     def __init__(self):
-        self.host = os.getenv("OLLAMA_HOST", "http://localhost:11434")
         self.model = os.getenv("OLLAMA_MODEL", "codellama:7b")
-        self.client = ollama.Client(host=self.host)
+        # One or more endpoints (OLLAMA_HOSTS / OLLAMA_HOST), each with its
+        # own limit on requests in flight; more just queue up here
+        self.pool = OllamaPool.from_env()
+        self.max_concurrency = self.pool.max_concurrency
+        # How long Ollama keeps the model (and its cached prompt prefix) loaded
+        # after a request, and the context size. num_ctx is sent with every
+        # request: a request with a different value makes Ollama reload the model.
+        self.keep_alive = keep_alive_setting()
+        num_ctx = os.getenv("OLLAMA_NUM_CTX")
+        self.base_options: Dict[str, Any] = {'num_ctx': int(num_ctx)} if num_ctx else {}
+        self.comment_options = {'temperature': 0.1, 'num_predict': 500, **self.base_options}
+        self.cache = LLMResponseCache()
+
+    async def _request(
+        self,
+        call: Callable[[ollama.AsyncClient], Awaitable[T]],
+        retryable: Callable[[], bool] = lambda: True
+    ) -> T:
+        """
+        Run call(client) on a pool host, retrying on another host if it fails
 
-    async def check_connection(self) -> bool:
-        """Check if Ollama is running and accessible"""
+        Each host is tried at most once. Errors caused by the request itself
+        (4xx other than a missing model) are raised without retrying or
+        blaming the host; `retryable` can veto a retry, e.g. once a streamed
+        response has been partly consumed.
+        """
+        tried: Set[str] = set()
+        while True:
+            async with self.pool.acquire(tried) as host:
+                try:
+                    with timed("llm_call"):
+                        result = await call(host.client)
+                except Exception as e:
+                    if not _host_fault(e):
+                        raise
+                    self.pool.mark_failure(host, e)
+                    tried.add(host.url)
+                    if len(tried) >= len(self.pool.hosts) or not retryable():
+                        raise
+                    logger.warning("Ollama request failed on %s, retrying on another host: %s", host.url, e)
+                    continue
+                self.pool.mark_success(host)
+                return result
+
+    async def check_connection(self, host: Optional[OllamaHost] = None) -> bool:
+        """Check if Ollama is running and accessible (on `host`, or on any pool host)"""
+        if host is None:
+            return any(await asyncio.gather(*[self.check_connection(h) for h in self.pool.hosts]))
         try:
-            self.client.list()
+            await host.client.list()
             return True
         except Exception as e:
-            print(f"Ollama connection error: {e}")
+            logger.warning("Ollama connection error (%s): %s", host.url, e)
             return False
 
-    async def check_model(self) -> bool:
-        """Check if CodeLlama model is available"""
+    async def check_model(self, host: Optional[OllamaHost] = None) -> bool:
+        """Check if CodeLlama model is available (on `host`, or on any pool host)"""
+        if host is None:
+            return any(await asyncio.gather(*[self.check_model(h) for h in self.pool.hosts]))
         try:
-            models = self.client.list()
+            models = await host.client.list()
             return any(self.model in m['name'] for m in models['models'])
         except Exception as e:
-            print(f"Error checking model availability: {e}")
+            logger.warning("Error checking model availability (%s): %s", host.url, e)
             return False
 
+    async def check_hosts(self) -> List[Dict[str, Any]]:
+        """
+        Health-check every pool host and update its routing state
+
+        A host is healthy when it is reachable and has the model.
+        """
+        async def check(host: OllamaHost) -> Dict[str, Any]:
+            running = await self.check_connection(host)
+            model_available = running and await self.check_model(host)
+            self.pool.set_health(host, model_available)
+            return {**host.status(), "running": running, "model_available": model_available}
+
+        return list(await asyncio.gather(*[check(h) for h in self.pool.hosts]))
+
+    async def warm_up(self) -> bool:
+        """
+        Load the model on every host before the first real request
+
+        The warm-up request carries the comment check's instruction prefix,
+        so the first files reuse it from the KV cache as well.
+        """
+        async def warm(host: OllamaHost) -> bool:
+            try:
+                # One tiny request per host, outside the routing slots
+                await host.client.chat(
+                    model=self.model,
+                    messages=self._build_comment_quality_messages("", numbered_code=""),
+                    options={**self.comment_options, 'num_predict': 1},
+                    keep_alive=self.keep_alive
+                )
+                self.pool.set_health(host, True)
+                return True
+            except Exception as e:
+                logger.warning("Ollama warm-up failed on %s: %s", host.url, e)
+                self.pool.set_health(host, False)
+                return False
+
+        return any(await asyncio.gather(*[warm(h) for h in self.pool.hosts]))
+
     async def analyze_code(
         self,
         code: str,
@@ -51,47 +262,31 @@ class OllamaService:
             List of Violation objects
         """
         try:
-            import time
-            start_time = time.time()
-
-            print(f"  -> Building analysis prompt...")
-            print(f"    Code length: {len(code)} chars")
-            print(f"    Style guide length: {len(style_guide)} chars")
-            if context:
-                print(f"    RAG context length: {len(context)} chars")
-
-            prompt = self._build_analysis_prompt(code, style_guide, context)
-            print(f"    Total prompt length: {len(prompt)} chars")
+            with timed("llm_prompt_build"):
+                messages = self._build_analysis_messages(code, style_guide, context)
+            logger.debug("Sending %d-character analysis prompt (%s)",
+                         sum(len(m['content']) for m in messages), self.model)
 
             # Call Ollama with the prompt
-            print(f"  -> Sending request to Ollama ({self.model})...")
-            print(f"    Host: {self.host}")
-
-            response = self.client.chat(
+            response = await self._request(lambda client: client.chat(
                 model=self.model,
-                messages=[
-                    {
-                        'role': 'user',
-                        'content': prompt
-                    }
-                ],
+                messages=messages,
                 options={
                     'temperature': 0.1,  # Low temperature for consistent analysis
-                    'num_predict': 2000  # Allow enough tokens for detailed analysis
-                }
-            )
-
-            elapsed = time.time() - start_time
-            print(f"  -> Received response from Ollama ({elapsed:.1f}s)")
+                    'num_predict': 2000,  # Allow enough tokens for detailed analysis
+                    **self.base_options
+                },
+                keep_alive=self.keep_alive
+            ))
+            record_llm_usage(response)
 
             # Extract the response content
             response_text = response['message']['content']
-            print(f"    Response length: {len(response_text)} chars")
 
             # Parse the JSON response
-            print(f"  -> Parsing LLM response...")
-            violations = self._parse_llm_response(response_text)
-            print(f"    Parsed {len(violations)} violations")
+            with timed("llm_parse"):
+                violations = self._parse_llm_response(response_text)
+            logger.debug("Parsed %d violations from a %d-character response", len(violations), len(response_text))
 
             return {
                 "violations": violations,
@@ -100,9 +295,7 @@ class OllamaService:
             }
 
         except Exception as e:
-            print(f"[ERROR] Error during code analysis: {e}")
-            import traceback
-            traceback.print_exc()
+            logger.exception("Error during code analysis: %s", e)
             return {
                 "violations": [],
                 "status": "error",
@@ -139,153 +332,151 @@ class OllamaService:
             # Normalize violation structure
             normalized = []
             for v in violations:
-                normalized.append({
-                    "type": v.get("type", "style_violation"),
-                    "severity": v.get("severity", "WARNING").upper(),
-                    "line_number": int(v.get("line_number", v.get("line", 1))),
-                    "description": v.get("description", "Style violation detected"),
-                    "rule_reference": v.get("rule_reference", v.get("reference", ""))
-                })
+                normalized.append(self._normalize_violation(v, strict=True))
 
             return normalized
 
         except Exception as e:
-            print(f"Error parsing LLM response: {e}")
-            print(f"Response text: {response_text[:500]}")  # Log first 500 chars
+            logger.warning("Error parsing LLM response: %s", e)
+            logger.debug("Response text: %s", response_text[:500])  # Log first 500 chars
             return []
 
-    def _build_analysis_prompt(
+    def _normalize_violation(self, v: Dict[str, Any], strict: bool = False) -> Optional[Dict[str, Any]]:
+        """Map an LLM violation object onto the fields the analyzer expects"""
+        try:
+            return {
+                "type": v.get("type", "style_violation"),
+                "severity": v.get("severity", "WARNING").upper(),
+                "line_number": int(v.get("line_number", v.get("line", 1))),
+                "description": v.get("description", "Style violation detected"),
+                "rule_reference": v.get("rule_reference", v.get("reference", ""))
+            }
+        except Exception:
+            if strict:
+                raise
+            return None
+
+    def _build_analysis_messages(
         self,
         code: str,
         style_guide: str,
         context: Optional[str] = None
-    ) -> str:
-        """Construct the prompt for code analysis"""
-
-        # Add line numbers to code for better accuracy
-        numbered_lines = []
-        for i, line in enumerate(code.split('\n'), 1):
-            numbered_lines.append(f"{i:4d} | {line}")
-        numbered_code = '\n'.join(numbered_lines)
-
-        base_prompt = f"""You are a C++ semantic code analyzer. Analyze ONLY the user's code shown below.
-
-TASK: Find semantic and logic issues in the CODE TO ANALYZE section.
+    ) -> List[Dict[str, str]]:
+        """
+        Construct the chat messages for code analysis
 
+        The fixed instructions and the style guide form the system message,
+        which stays byte-identical across the files of a run so Ollama can
+        reuse its cached prefix; the per-file parts follow in the user message.
+        """
+        system = f"""{ANALYSIS_INSTRUCTIONS}
 RULES TO CHECK (reference only - NOT code to analyze):
-{style_guide}
-"""
+{style_guide}"""
 
+        user = ""
         # RAG context integration point (for future)
         if context:
-            base_prompt += f"""ADDITIONAL CONTEXT:
+            user += f"""ADDITIONAL CONTEXT:
 {context}
-"""
-
-        base_prompt += f"""
->>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-CODE TO ANALYZE (with line numbers):
->>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-{numbered_code}
->>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-END OF CODE - Analyze the code above ONLY
->>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-
-WHAT TO LOOK FOR:
-- Memory leaks: new/malloc without delete/free
-- Wrong delete: delete[] vs delete mismatch
-- Naming: camelCase for functions, PascalCase for classes
-- Magic numbers: hardcoded values like 18, 500, 1.15
-- NULL vs nullptr
-- Missing switch default
-- Variable shadowing
-- Deep nesting (>3 levels)
-- Long functions (>50 lines)
-- Uninitialized variables
-
-DO NOT REPORT:
-- Formatting (tabs/spaces/braces/line length)
-- Missing comments (handled separately)
-
-CRITICAL: Before reporting a violation, verify:
-1. The violation exists in the CODE TO ANALYZE section (NOT the rules section)
-2. The line number is correct (use numbers before the | symbol)
-3. The code on that line actually has the issue you're reporting
-
-OUTPUT FORMAT (JSON array only, no other text):
-[
-  {{
-    "type": "memory_leak",
-    "severity": "CRITICAL",
-    "line_number": 5,
-    "description": "new int[100] without delete[]",
-    "rule_reference": "Memory Management"
-  }}
-]
-
-If NO violations found, return: []
 
-Only return valid JSON. No explanations, no markdown, just the JSON array."""
+"""
+        user += f"""CODE TO ANALYZE (with line numbers):
+{number_lines(code)}
+END OF CODE"""
 
-        return base_prompt
+        return [{'role': 'system', 'content': system}, {'role': 'user', 'content': user}]
 
-    async def check_comment_quality(self, code: str) -> Dict[str, Any]:
+    async def check_comment_quality(self, code: str, numbered_code: Optional[str] = None) -> Dict[str, Any]:
         """
         Simple LLM task: Check if comments are descriptive and useful.
         This is a basic task the LLM can reliably handle.
 
         Args:
             code: C++ source code to analyze
+            numbered_code: Pre-numbered excerpt to send instead of the whole
+                           file (see app.parsers.code_units.render_batch)
 
         Returns:
             Dictionary containing comment quality issues
         """
         try:
-            # Add line numbers to code
-            numbered_lines = []
-            for i, line in enumerate(code.split('\n'), 1):
-                numbered_lines.append(f"{i:4d} | {line}")
-            numbered_code = '\n'.join(numbered_lines)
-
-            prompt = f"""You are checking comment quality in C++ code. This is a SIMPLE task.
-
-CODE WITH LINE NUMBERS:
-{numbered_code}
-
-TASK: Find comments that are NOT descriptive or useful.
-
-ONLY report comments that are:
-1. Too vague (e.g., "// x" or "// temp")
-2. Completely unhelpful (e.g., "// code" or "// function")
-3. Obvious/redundant (e.g., "// increment i" for i++)
-
-DO NOT report:
-- Missing comments (handled separately)
-- Code issues (only check comments)
+            with timed("llm_prompt_build"):
+                messages = self._build_comment_quality_messages(code, numbered_code)
+            response = await self._request(lambda client: client.chat(
+                model=self.model,
+                messages=messages,
+                options=self.comment_options,
+                keep_alive=self.keep_alive
+            ))
+            record_llm_usage(response)
 
-If ALL comments are adequately descriptive, return: []
+            response_text = response['message']['content']
+            with timed("llm_parse"):
+                violations = self._parse_llm_response(response_text)
 
-OUTPUT FORMAT (JSON array only, no other text):
-[
-  {{
-    "type": "poor_comment_quality",
-    "severity": "MINOR",
-    "line_number": 5,
-    "description": "Comment is too vague",
-    "rule_reference": "Code Documentation"
-  }}
-]
+            return {
+                "violations": violations,
+                "status": "success"
+            }
 
-Only return valid JSON. If no issues, return: []"""
+        except Exception as e:
+            logger.error("Error during comment quality check: %s", e)
+            return {
+                "violations": [],
+                "status": "error",
+                "error": str(e)
+            }
 
-            response = self.client.chat(
-                model=self.model,
-                messages=[{'role': 'user', 'content': prompt}],
-                options={'temperature': 0.1, 'num_predict': 500}
-            )
+    async def check_comment_quality_stream(
+        self,
+        code: str,
+        on_violation: Callable[[Dict[str, Any]], None],
+        numbered_code: Optional[str] = None
+    ) -> Dict[str, Any]:
+        """
+        Streaming variant of check_comment_quality
 
-            response_text = response['message']['content']
-            violations = self._parse_llm_response(response_text)
+        Uses Ollama's streaming chat mode and calls on_violation with each
+        violation object as soon as it has been fully generated. The returned
+        dictionary has the same shape as check_comment_quality(); its
+        violations come from parsing the complete response.
+        """
+        try:
+            parser = JsonObjectStream()
+            parts = []
+            streamed = []
+            with timed("llm_prompt_build"):
+                messages = self._build_comment_quality_messages(code, numbered_code)
+
+            # Streamed objects are parsed while generating, so the call includes that parsing
+            async def consume(client: ollama.AsyncClient) -> None:
+                stream = await client.chat(
+                    model=self.model,
+                    messages=messages,
+                    options=self.comment_options,
+                    keep_alive=self.keep_alive,
+                    stream=True
+                )
+                async for chunk in stream:
+                    if chunk.get('done'):
+                        record_llm_usage(chunk)
+                    text = chunk['message']['content']
+                    parts.append(text)
+                    for obj in parser.feed(text):
+                        violation = self._normalize_violation(obj)
+                        if violation is not None:
+                            streamed.append(violation)
+                            on_violation(violation)
+
+            # Another host may only take over before anything was streamed
+            await self._request(consume, retryable=lambda: not parts)
+
+            response_text = ''.join(parts)
+            with timed("llm_parse"):
+                violations = self._parse_llm_response(response_text)
+            # The full parse fails on truncated output; keep what was streamed
+            if not violations and streamed:
+                violations = streamed
 
             return {
                 "violations": violations,
@@ -293,9 +484,102 @@ Only return valid JSON. If no issues, return: []"""
             }
 
         except Exception as e:
-            print(f"[ERROR] Error during comment quality check: {e}")
+            logger.error("Error during comment quality check: %s", e)
             return {
                 "violations": [],
                 "status": "error",
                 "error": str(e)
             }
+
+    def comment_review_config(self) -> Dict[str, Any]:
+        """What a comment check's findings depend on besides the code"""
+        return {"prompt": COMMENT_PROMPT_VERSION, "model": self.model, "options": self.comment_options}
+
+    def _comment_review_key(self, unit_text: str) -> str:
+        return self.cache.make_key(unit_text, COMMENT_PROMPT_VERSION, self.model, self.comment_options)
+
+    def cached_comment_review(self, unit_text: str) -> Optional[List[Dict[str, Any]]]:
+        """
+        Findings of an earlier comment check of the same code unit
+
+        Returns normalized violation dicts whose line_number is relative to the
+        first line of the unit (1 = first line), or None if not cached.
+        """
+        return self.cache.get(self._comment_review_key(unit_text))
+
+    def store_comment_review(self, unit_text: str, findings: List[Dict[str, Any]]) -> None:
+        """Cache the findings for a unit (line numbers relative to the unit, as above)"""
+        self.cache.put(self._comment_review_key(unit_text), findings)
+
+    def _build_comment_quality_messages(self, code: str, numbered_code: Optional[str] = None) -> List[Dict[str, str]]:
+        """Construct the chat messages for the comment quality check: fixed instructions, then the code"""
+        if numbered_code is None:
+            numbered_code = number_lines(code)
+        return [
+            {'role': 'system', 'content': COMMENT_QUALITY_INSTRUCTIONS},
+            {'role': 'user', 'content': f"CODE WITH LINE NUMBERS:\n{numbered_code}"},
+        ]
+
+
+class JsonObjectStream:
+    """
+    Incrementally extract top-level JSON objects from streamed text
+
+    The LLM answers with a JSON array of objects; feed() is given each text
+    chunk as it arrives and returns the objects completed by that chunk.
+    Braces inside string literals are ignored. Text outside objects
+    (brackets, commas, markdown fences) is skipped.
+    """
+
+    def __init__(self):
+        self._buffer: List[str] = []
+        self._depth = 0
+        self._in_string = False
+        self._escaped = False
+
+    def feed(self, text: str) -> List[Dict[str, Any]]:
+        completed = []
+        for ch in text:
+            if self._depth == 0:
+                if ch == '{':
+                    self._depth = 1
+                    self._buffer = [ch]
+                continue
+
+            self._buffer.append(ch)
+            if self._in_string:
+                if self._escaped:
+                    self._escaped = False
+                elif ch == '\\':
+                    self._escaped = True
+                elif ch == '"':
+                    self._in_string = False
+            elif ch == '"':
+                self._in_string = True
+            elif ch == '{':
+                self._depth += 1
+            elif ch == '}':
+                self._depth -= 1
+                if self._depth == 0:
+                    try:
+                        obj = json.loads(''.join(self._buffer))
+                        if isinstance(obj, dict):
+                            completed.append(obj)
+                    except json.JSONDecodeError:
+                        pass
+                    self._buffer = []
+        return completed
+
+
+_ollama_service: Optional[OllamaService] = None
+_ollama_service_lock = threading.Lock()
+
+
+def get_ollama_service() -> OllamaService:
+    """Process-wide OllamaService, sharing one client, concurrency limit and cache"""
+    global _ollama_service
+    if _ollama_service is None:
+        with _ollama_service_lock:
+            if _ollama_service is None:
+                _ollama_service = OllamaService()
+    return _ollama_service
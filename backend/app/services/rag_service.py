@@ -1,13 +1,18 @@
 """
 RAG (Retrieval-Augmented Generation) service for context-aware analysis
 """
-from typing import List, Optional, Dict, Any
+from typing import Any, Callable, Dict, List, Optional
+import asyncio
+import logging
 import os
+import threading
 import uuid
 import chromadb
 from chromadb.config import Settings
 from sentence_transformers import SentenceTransformer
 
+logger = logging.getLogger(__name__)
+
 
 class RAGService:
     """Manage RAG knowledge base for style guides and references"""
@@ -16,18 +21,48 @@ class RAGService:
         self.rag_data_path = os.getenv("RAG_DATA_PATH", "./rag_data")
         self.chunk_size = int(os.getenv("CHUNK_SIZE", "500"))
         self.chunk_overlap = int(os.getenv("CHUNK_OVERLAP", "50"))
-
-        # Initialize ChromaDB and embedder
-        self.chroma_client = chromadb.PersistentClient(
-            path=self.rag_data_path,
-            settings=Settings(anonymized_telemetry=False)
-        )
-        self.embedder = SentenceTransformer('all-MiniLM-L6-v2')
-        self.collection = self._get_or_create_collection()
+        # Chunks per embedder call and per ChromaDB write during ingestion
+        self.embed_batch_size = max(1, int(os.getenv("RAG_EMBED_BATCH_SIZE", "128")))
+
+        # ChromaDB and the embedder are opened on first use (see get_rag_service)
+        self._chroma_client = None
+        self._collection = None
+        self._embedder: Optional[SentenceTransformer] = None
+        self._init_lock = threading.Lock()
+
+    @property
+    def embedder(self) -> SentenceTransformer:
+        if self._embedder is None:
+            with self._init_lock:
+                if self._embedder is None:
+                    self._embedder = SentenceTransformer('all-MiniLM-L6-v2')
+        return self._embedder
+
+    @property
+    def collection(self):
+        if self._collection is None:
+            with self._init_lock:
+                if self._collection is None:
+                    self._chroma_client = chromadb.PersistentClient(
+                        path=self.rag_data_path,
+                        settings=Settings(anonymized_telemetry=False)
+                    )
+                    self._collection = self._get_or_create_collection()
+        return self._collection
+
+    @property
+    def loaded(self) -> bool:
+        """Whether the embedding model is in memory"""
+        return self._embedder is not None
+
+    def warm_up(self) -> None:
+        """Load the embedder and ChromaDB and run one embedding"""
+        self.embedder.encode(["warm-up"], show_progress_bar=False)
+        _ = self.collection
 
     def _get_or_create_collection(self):
         """Get or create ChromaDB collection"""
-        return self.chroma_client.get_or_create_collection(
+        return self._chroma_client.get_or_create_collection(
             name="code_style_guides",
             metadata={"description": "Code style guides and reference documents"}
         )
@@ -49,54 +84,84 @@ class RAGService:
         Returns:
             Document ID
         """
-        # Generate unique document ID
-        doc_id = str(uuid.uuid4())
-        print(f"\n{'='*60}")
-        print(f"Adding document to RAG database")
-        print(f"Document ID: {doc_id}")
-        print(f"Type: {doc_type}")
-        print(f"Content length: {len(content)} chars")
-        if metadata:
-            print(f"Metadata: {metadata}")
-        print(f"{'='*60}\n")
-
-        # Chunk the document
-        print(f"Step 1: Chunking document...")
-        chunks = self._chunk_document(content)
-        print(f"[OK] Created {len(chunks)} chunks")
-
-        # Generate embeddings for each chunk
-        print(f"Step 2: Generating embeddings...")
-        embeddings = self.embedder.encode(chunks).tolist()
-        print(f"[OK] Generated {len(embeddings)} embeddings")
-
-        # Prepare metadata for each chunk
-        print(f"Step 3: Preparing metadata...")
-        chunk_ids = [f"{doc_id}_chunk_{i}" for i in range(len(chunks))]
-        chunk_metadata = []
-        for i in range(len(chunks)):
-            meta = {
-                "doc_id": doc_id,
-                "doc_type": doc_type,
-                "chunk_index": i,
-                "total_chunks": len(chunks)
-            }
-            if metadata:
-                meta.update(metadata)
-            chunk_metadata.append(meta)
-
-        # Add to ChromaDB
-        print(f"Step 4: Storing in ChromaDB...")
-        self.collection.add(
-            ids=chunk_ids,
-            embeddings=embeddings,
-            documents=chunks,
-            metadatas=chunk_metadata
-        )
+        return self.add_documents([{"content": content, "doc_type": doc_type, "metadata": metadata}])[0]
+
+    def add_documents(
+        self,
+        documents: List[Dict[str, Any]],
+        progress: Optional[Callable[[int, int], None]] = None
+    ) -> List[str]:
+        """
+        Add many documents to the RAG knowledge base at once
+
+        All documents are chunked first; the chunks are then embedded in
+        batches of RAG_EMBED_BATCH_SIZE and each batch is written to ChromaDB
+        with a single collection.add().
+
+        Args:
+            documents: Dicts with "content", "doc_type" and optional "metadata"
+            progress: Called with (chunks stored, total chunks) after each batch
 
-        print(f"[OK] Successfully added document {doc_id} to RAG database")
-        print(f"{'='*60}\n")
-        return doc_id
+        Returns:
+            Document IDs, in the order of documents
+        """
+        doc_ids: List[str] = []
+        chunk_ids: List[str] = []
+        chunk_texts: List[str] = []
+        chunk_metadata: List[Dict[str, Any]] = []
+        for doc in documents:
+            doc_id = str(uuid.uuid4())
+            doc_ids.append(doc_id)
+            chunks = self._chunk_document(doc["content"])
+            for i, chunk in enumerate(chunks):
+                meta = {
+                    "doc_id": doc_id,
+                    "doc_type": doc["doc_type"],
+                    "chunk_index": i,
+                    "total_chunks": len(chunks)
+                }
+                if doc.get("metadata"):
+                    meta.update(doc["metadata"])
+                chunk_ids.append(f"{doc_id}_chunk_{i}")
+                chunk_texts.append(chunk)
+                chunk_metadata.append(meta)
+
+        total = len(chunk_texts)
+        for start in range(0, total, self.embed_batch_size):
+            end = min(start + self.embed_batch_size, total)
+            embeddings = self.embedder.encode(
+                chunk_texts[start:end],
+                batch_size=self.embed_batch_size,
+                show_progress_bar=False
+            ).tolist()
+            self.collection.add(
+                ids=chunk_ids[start:end],
+                embeddings=embeddings,
+                documents=chunk_texts[start:end],
+                metadatas=chunk_metadata[start:end]
+            )
+            if progress is not None:
+                progress(end, total)
+
+        logger.info("Added %d document(s), %d chunks, to RAG database", len(doc_ids), total)
+        return doc_ids
+
+    async def add_document_async(
+        self,
+        content: str,
+        doc_type: str,
+        metadata: Optional[dict] = None
+    ) -> str:
+        """add_document() on a worker thread, for use from request handlers"""
+        return await asyncio.to_thread(self.add_document, content, doc_type, metadata)
+
+    async def add_documents_async(
+        self,
+        documents: List[Dict[str, Any]],
+        progress: Optional[Callable[[int, int], None]] = None
+    ) -> List[str]:
+        """add_documents() on a worker thread"""
+        return await asyncio.to_thread(self.add_documents, documents, progress)
 
     def _chunk_document(self, content: str) -> List[str]:
         """
@@ -110,75 +175,64 @@ class RAGService:
         """
         chunks = []
         lines = content.split('\n')
-        current_chunk = []
+        # The current chunk is lines[start:i]; only its size is tracked
+        start = 0
         current_size = 0
 
-        for line in lines:
+        for i, line in enumerate(lines):
             line_size = len(line)
 
-            if current_size + line_size > self.chunk_size and current_chunk:
+            if current_size + line_size > self.chunk_size and i > start:
                 # Save current chunk
-                chunks.append('\n'.join(current_chunk))
+                chunks.append('\n'.join(lines[start:i]))
 
-                # Start new chunk with overlap
-                overlap_lines = current_chunk[-3:]  # Keep last 3 lines for overlap
-                current_chunk = overlap_lines + [line]
-                current_size = sum(len(l) for l in current_chunk)
-            else:
-                current_chunk.append(line)
-                current_size += line_size
+                # Start new chunk with overlap: keep the last 3 lines
+                start = max(start, i - 3)
+                current_size = sum(len(l) for l in lines[start:i])
+            current_size += line_size
 
         # Add final chunk
-        if current_chunk:
-            chunks.append('\n'.join(current_chunk))
+        if start < len(lines):
+            chunks.append('\n'.join(lines[start:]))
 
         return chunks
 
-    def search_relevant_context(
-        self,
-        query: str,
-        top_k: int = 3
-    ) -> List[str]:
+    def rule_contexts(self, style_guide_id: str, queries: Dict[str, str], top_k: int = 2) -> Dict[str, List[str]]:
         """
-        Search for relevant context based on query
+        Top chunks of one style guide for each of several queries, in one ChromaDB query
 
-        Args:
-            query: Search query (e.g., code snippet or violation description)
-            top_k: Number of results to return
-
-        Returns:
-            List of relevant text chunks
+        Used when a guide is uploaded to precompute its excerpts per rule
+        category (app.services.rule_context), so analyses look them up
+        instead of searching. Categories without a match are left out.
         """
+        names = list(queries)
+        if not names:
+            return {}
         try:
-            print(f"  -> Searching RAG database...")
-            print(f"    Query length: {len(query)} chars")
-            print(f"    Requesting top {top_k} results")
-
-            # Generate query embedding
-            print(f"  -> Generating query embedding...")
-            query_embedding = self.embedder.encode([query])[0].tolist()
-
-            # Search ChromaDB
-            print(f"  -> Querying ChromaDB collection...")
+            # Filtered HNSW queries can fail when asking for more results than the partition has
+            chunks = len(self.collection.get(include=[], **self._partition(style_guide_id))['ids'])
+            if chunks == 0:
+                return {}
             results = self.collection.query(
-                query_embeddings=[query_embedding],
-                n_results=top_k
+                query_embeddings=self.embedder.encode(
+                    [queries[name] for name in names], show_progress_bar=False
+                ).tolist(),
+                n_results=min(top_k, chunks),
+                **self._partition(style_guide_id)
             )
+        except Exception as e:
+            logger.error("Error precomputing rule contexts for %s: %s", style_guide_id, e)
+            return {}
+        found = (results or {}).get('documents') or []
+        return {name: list(docs) for name, docs in zip(names, found) if docs}
 
-            # Extract and return document texts
-            if results and 'documents' in results and len(results['documents']) > 0:
-                found_docs = results['documents'][0]
-                print(f"    Found {len(found_docs)} relevant chunks")
-                return found_docs  # First query's results
-
-            print(f"    No documents found in RAG database")
-            return []
+    async def rule_contexts_async(self, style_guide_id: str, queries: Dict[str, str], top_k: int = 2) -> Dict[str, List[str]]:
+        """rule_contexts() on a worker thread"""
+        return await asyncio.to_thread(self.rule_contexts, style_guide_id, queries, top_k)
 
-        except Exception as e:
-            print(f"[ERROR] Error searching for context: {e}")
-            import traceback
-            traceback.print_exc()
-            return []
+    def _partition(self, style_guide_id: Optional[str]) -> Dict[str, Any]:
+        # Every chunk carries its document's doc_id, which is the style guide ID
+        return {"where": {"doc_id": style_guide_id}} if style_guide_id else {}
 
     def delete_document(self, doc_id: str) -> bool:
         """Remove document from knowledge base"""
@@ -191,15 +245,19 @@ class RAGService:
             if results and 'ids' in results and len(results['ids']) > 0:
                 # Delete all chunks
                 self.collection.delete(ids=results['ids'])
-                print(f"Deleted document {doc_id} with {len(results['ids'])} chunks")
+                logger.info("Deleted document %s with %d chunks", doc_id, len(results['ids']))
                 return True
 
             return False
 
         except Exception as e:
-            print(f"Error deleting document: {e}")
+            logger.error("Error deleting document: %s", e)
             return False
 
+    async def delete_document_async(self, doc_id: str) -> bool:
+        """delete_document() on a worker thread"""
+        return await asyncio.to_thread(self.delete_document, doc_id)
+
     def list_documents(self) -> List[Dict[str, Any]]:
         """List all documents in knowledge base"""
         try:
@@ -224,5 +282,19 @@ class RAGService:
             return list(docs_dict.values())
 
         except Exception as e:
-            print(f"Error listing documents: {e}")
+            logger.error("Error listing documents: %s", e)
             return []
+
+
+_rag_service: Optional[RAGService] = None
+_rag_service_lock = threading.Lock()
+
+
+def get_rag_service() -> RAGService:
+    """Process-wide RAGService, so the embedder is loaded at most once per process"""
+    global _rag_service
+    if _rag_service is None:
+        with _rag_service_lock:
+            if _rag_service is None:
+                _rag_service = RAGService()
+    return _rag_service
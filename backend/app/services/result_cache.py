@@ -0,0 +1,113 @@
+"""
+Persistent cache of analysis results keyed by content hash
+"""
+import hashlib
+import json
+import logging
+import os
+import sqlite3
+import threading
+import time
+from typing import Any, Dict, Optional
+from app.models.core import AnalysisResult
+
+logger = logging.getLogger(__name__)
+
+
+def content_hash(text: str) -> str:
+    """Stable hash of a text body (file content, style guide)"""
+    return hashlib.sha256(text.encode("utf-8")).hexdigest()
+
+
+class AnalysisResultCache:
+    """
+    SQLite-backed cache of AnalysisResult objects
+
+    Entries are keyed by (file hash, style guide hash, use_rag, analyzer
+    version), so identical submissions graded against the same guide skip
+    the rule checks and the LLM entirely. With use_rag the LLM setup (model,
+    options, prompt version) is part of the key too, so switching models
+    does not serve results graded by the old one. Bumping the analyzer
+    version invalidates every earlier entry.
+    """
+
+    def __init__(self, path: Optional[str] = None):
+        rag_data_path = os.getenv("RAG_DATA_PATH", "./rag_data")
+        self.path = path or os.getenv("ANALYSIS_CACHE_PATH", os.path.join(rag_data_path, "analysis_cache.sqlite3"))
+        self.enabled = os.getenv("ANALYSIS_CACHE_ENABLED", "true").lower() != "false"
+        self._lock = threading.Lock()
+        self._conn: Optional[sqlite3.Connection] = None
+
+    def _connection(self) -> sqlite3.Connection:
+        if self._conn is None:
+            os.makedirs(os.path.dirname(os.path.abspath(self.path)), exist_ok=True)
+            conn = sqlite3.connect(self.path, check_same_thread=False)
+            conn.execute("PRAGMA journal_mode=WAL")
+            conn.execute(
+                "CREATE TABLE IF NOT EXISTS analysis_results ("
+                " cache_key TEXT PRIMARY KEY,"
+                " result_json TEXT NOT NULL,"
+                " created_at REAL NOT NULL)"
+            )
+            conn.commit()
+            self._conn = conn
+        return self._conn
+
+    def make_key(
+        self, file_content: str, style_guide: str, use_rag: bool, analyzer_version: str,
+        llm_config: Optional[Dict[str, Any]] = None
+    ) -> str:
+        return self.make_key_for_hash(content_hash(file_content), style_guide, use_rag, analyzer_version, llm_config)
+
+    def make_key_for_hash(
+        self, file_hash: str, style_guide: str, use_rag: bool, analyzer_version: str,
+        llm_config: Optional[Dict[str, Any]] = None
+    ) -> str:
+        """
+        make_key for a file known by its content_hash (e.g. its blob digest), without the content
+
+        llm_config (OllamaService.comment_review_config()) only counts with use_rag.
+        """
+        base = f"{file_hash}:{content_hash(style_guide or '')}:{int(use_rag)}:{analyzer_version}"
+        if use_rag and llm_config:
+            base += ":" + json.dumps(llm_config, sort_keys=True)
+        return hashlib.sha256(base.encode("utf-8")).hexdigest()
+
+    def get(self, key: str) -> Optional[AnalysisResult]:
+        """Return the cached result for key, or None on a miss"""
+        if not self.enabled:
+            return None
+        try:
+            with self._lock:
+                row = self._connection().execute(
+                    "SELECT result_json FROM analysis_results WHERE cache_key = ?", (key,)
+                ).fetchone()
+            if row is None:
+                return None
+            return AnalysisResult.model_validate_json(row[0])
+        except Exception as e:
+            logger.warning("Analysis cache read failed: %s", e)
+            return None
+
+    def put(self, key: str, result: AnalysisResult) -> None:
+        """Store a successful result"""
+        if not self.enabled or result.status != "success":
+            return
+        try:
+            with self._lock:
+                conn = self._connection()
+                conn.execute(
+                    "INSERT OR REPLACE INTO analysis_results (cache_key, result_json, created_at) VALUES (?, ?, ?)",
+                    (key, result.model_dump_json(), time.time())
+                )
+                conn.commit()
+        except Exception as e:
+            logger.warning("Analysis cache write failed: %s", e)
+
+    def clear(self) -> None:
+        if not self.enabled:
+            return
+        with self._lock:
+            conn = self._connection()
+            conn.execute("DELETE FROM analysis_results")
+            conn.commit()
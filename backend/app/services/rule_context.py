@@ -0,0 +1,48 @@
+"""
+Style guide excerpts per rule category, retrieved once per guide
+
+When a style guide is uploaded, its chunks are searched once for each rule
+category below (RAGService.rule_contexts, limited to that guide's chunks)
+and the excerpts are stored with the guide's rule plan. Analyses then look
+up the excerpts for the violation types they found instead of running a
+vector search per file.
+"""
+from typing import Dict, Iterable, List, Optional
+
+# Retrieval query per rule category
+RULE_CATEGORIES: Dict[str, str] = {
+    "indentation": "indentation, nesting levels, tabs and spaces",
+    "line_length": "maximum line length and long lines",
+    "braces": "brace placement and braces around if, for and while bodies",
+    "comments": "comments, documentation and file header comments",
+    "naming": "naming conventions for variables, functions and classes",
+    "memory": "memory management, new and delete, ownership and leaks",
+    "constants": "magic numbers and named constants",
+    "null_pointers": "null pointers, NULL and nullptr",
+}
+
+# Rule category of each violation type the analyzer reports
+VIOLATION_CATEGORIES: Dict[str, str] = {
+    "improper_indentation": "indentation",
+    "mixed_indentation": "indentation",
+    "line_too_long": "line_length",
+    "missing_braces": "braces",
+    "missing_file_header": "comments",
+    "no_comments": "comments",
+    "poor_comment_quality": "comments",
+    "naming_convention": "naming",
+    "memory_leak": "memory",
+    "wrong_delete_type": "memory",
+    "magic_number": "constants",
+    "use_nullptr": "null_pointers",
+}
+
+
+def guide_context(rule_contexts: Dict[str, List[str]], violation_types: Iterable[str]) -> Optional[Dict[str, str]]:
+    """The top excerpt of the guide for each violation type with a precomputed category, or None"""
+    context = {}
+    for violation_type in violation_types:
+        excerpts = rule_contexts.get(VIOLATION_CATEGORIES.get(violation_type, ""))
+        if excerpts:
+            context[violation_type] = excerpts[0]
+    return context or None
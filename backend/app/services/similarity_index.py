@@ -0,0 +1,273 @@
+"""
+Near-duplicate index over uploaded files
+
+Each file gets a MinHash signature of its token shingles (comments and
+whitespace removed, so reformatting or re-commenting a copy does not hide
+it). Signatures are banded for locality-sensitive lookup: files sharing any
+band are candidates, and the fraction of equal signature slots estimates
+their Jaccard similarity. Used to analyze lightly edited copies of an earlier
+submission incrementally, and to show clusters of near-identical files.
+"""
+import hashlib
+import logging
+import os
+import re
+import sqlite3
+import threading
+import time
+from array import array
+from collections import defaultdict
+from typing import Dict, Iterable, List, Optional, Tuple
+
+logger = logging.getLogger(__name__)
+
+SHINGLE_TOKENS = 5
+NUM_SLOTS = 64
+BANDS = 16  # 4 slots per band: pairs at 0.8 similarity share a band with probability ~0.9998
+ROWS = NUM_SLOTS // BANDS
+EMPTY_SLOT = (1 << 64) - 1
+
+# Comments are matched (and dropped) before anything else can match inside them
+TOKEN_RE = re.compile(
+    r'//[^\n]*|/\*[\s\S]*?\*/'
+    r'|"(?:\\.|[^"\\\n])*"|\'(?:\\.|[^\'\\\n])*\''
+    r'|[A-Za-z_]\w*|\d[\w.]*|\S'
+)
+
+
+def normalized_tokens(code: str) -> List[str]:
+    return [t for t in TOKEN_RE.findall(code) if not t.startswith(("//", "/*"))]
+
+
+def minhash(code: str) -> List[int]:
+    """
+    One-permutation MinHash of the file's token shingles
+
+    Each shingle is hashed once; the hash picks a slot and the rest of it
+    competes for that slot's minimum. Slots no shingle fell into stay
+    EMPTY_SLOT.
+    """
+    tokens = normalized_tokens(code)
+    signature = [EMPTY_SLOT] * NUM_SLOTS
+    for i in range(max(1, len(tokens) - SHINGLE_TOKENS + 1)):
+        shingle = "\x1f".join(tokens[i:i + SHINGLE_TOKENS])
+        if not shingle:
+            continue
+        h = int.from_bytes(hashlib.blake2b(shingle.encode("utf-8"), digest_size=8).digest(), "little")
+        slot = h % NUM_SLOTS
+        if h < signature[slot]:
+            signature[slot] = h
+    return signature
+
+
+def similarity(a: List[int], b: List[int]) -> float:
+    """Estimated Jaccard similarity of two signatures"""
+    used = equal = 0
+    for x, y in zip(a, b):
+        if x == EMPTY_SLOT and y == EMPTY_SLOT:
+            continue
+        used += 1
+        equal += x == y
+    return equal / used if used else 0.0
+
+
+def band_keys(signature: List[int]) -> List[int]:
+    keys = []
+    for band in range(BANDS):
+        rows = signature[band * ROWS:(band + 1) * ROWS]
+        digest = hashlib.blake2b(array("Q", rows).tobytes(), digest_size=8).digest()
+        # SQLite integers are signed 64-bit
+        keys.append(int.from_bytes(digest, "little", signed=True))
+    return keys
+
+
+def near_duplicate_threshold() -> float:
+    return float(os.getenv("NEAR_DUPLICATE_THRESHOLD", "0.8"))
+
+
+def near_duplicate_reuse() -> bool:
+    """Whether analyses may start from a near-duplicate's snapshot"""
+    return os.getenv("NEAR_DUPLICATE_REUSE", "true").lower() != "false"
+
+
+class SimilarityIndex:
+    """SQLite-backed MinHash signatures and LSH band buckets, shared by all server processes"""
+
+    def __init__(self, path: Optional[str] = None):
+        rag_data_path = os.getenv("RAG_DATA_PATH", "./rag_data")
+        self.path = path or os.getenv("SIMILARITY_INDEX_PATH", os.path.join(rag_data_path, "similarity.sqlite3"))
+        self._lock = threading.Lock()
+        self._conn: Optional[sqlite3.Connection] = None
+
+    def _connection(self) -> sqlite3.Connection:
+        if self._conn is None:
+            os.makedirs(os.path.dirname(os.path.abspath(self.path)), exist_ok=True)
+            conn = sqlite3.connect(self.path, check_same_thread=False)
+            conn.execute("PRAGMA journal_mode=WAL")
+            conn.execute("PRAGMA busy_timeout=5000")
+            conn.execute(
+                "CREATE TABLE IF NOT EXISTS signatures ("
+                " file_id TEXT PRIMARY KEY,"
+                " signature BLOB NOT NULL,"
+                " created_at REAL NOT NULL)"
+            )
+            conn.execute(
+                "CREATE TABLE IF NOT EXISTS bands ("
+                " band INTEGER NOT NULL,"
+                " bucket INTEGER NOT NULL,"
+                " file_id TEXT NOT NULL)"
+            )
+            conn.execute("CREATE INDEX IF NOT EXISTS bands_bucket ON bands (band, bucket)")
+            conn.execute("CREATE INDEX IF NOT EXISTS bands_file ON bands (file_id)")
+            conn.commit()
+            self._conn = conn
+        return self._conn
+
+    def add(self, file_id: str, code: str) -> None:
+        """Index (or re-index, for a new revision) a file"""
+        signature = minhash(code)
+        try:
+            with self._lock:
+                conn = self._connection()
+                with conn:
+                    conn.execute("DELETE FROM bands WHERE file_id = ?", (file_id,))
+                    conn.execute(
+                        "INSERT INTO signatures (file_id, signature, created_at) VALUES (?, ?, ?)"
+                        " ON CONFLICT (file_id) DO UPDATE SET signature = excluded.signature",
+                        (file_id, array("Q", signature).tobytes(), time.time())
+                    )
+                    conn.executemany(
+                        "INSERT INTO bands (band, bucket, file_id) VALUES (?, ?, ?)",
+                        [(band, key, file_id) for band, key in enumerate(band_keys(signature))]
+                    )
+        except Exception as e:
+            logger.warning("Similarity index write failed: %s", e)
+
+    def remove(self, file_id: str) -> None:
+        try:
+            with self._lock:
+                conn = self._connection()
+                with conn:
+                    conn.execute("DELETE FROM bands WHERE file_id = ?", (file_id,))
+                    conn.execute("DELETE FROM signatures WHERE file_id = ?", (file_id,))
+        except Exception as e:
+            logger.warning("Similarity index delete failed: %s", e)
+
+    def signatures(self, file_ids: Optional[Iterable[str]] = None) -> Dict[str, List[int]]:
+        """Signatures of the given files (all files when None), in upload order"""
+        with self._lock:
+            rows = self._connection().execute(
+                "SELECT file_id, signature FROM signatures ORDER BY created_at, file_id"
+            ).fetchall()
+        wanted = set(file_ids) if file_ids is not None else None
+        return {
+            file_id: array("Q", blob).tolist()
+            for file_id, blob in rows if wanted is None or file_id in wanted
+        }
+
+    def find_similar(self, file_id: str, threshold: Optional[float] = None, limit: int = 10) -> List[Tuple[str, float]]:
+        """Other files at least `threshold` similar to file_id, most similar first"""
+        threshold = near_duplicate_threshold() if threshold is None else threshold
+        try:
+            with self._lock:
+                conn = self._connection()
+                row = conn.execute("SELECT signature FROM signatures WHERE file_id = ?", (file_id,)).fetchone()
+                if row is None:
+                    return []
+                rows = conn.execute(
+                    "SELECT DISTINCT s.file_id, s.signature FROM bands b"
+                    " JOIN bands c ON c.band = b.band AND c.bucket = b.bucket AND c.file_id != b.file_id"
+                    " JOIN signatures s ON s.file_id = c.file_id"
+                    " WHERE b.file_id = ?", (file_id,)
+                ).fetchall()
+        except Exception as e:
+            logger.warning("Similarity index read failed: %s", e)
+            return []
+        signature = array("Q", row[0]).tolist()
+        matches = [(other, similarity(signature, array("Q", blob).tolist())) for other, blob in rows]
+        matches = [m for m in matches if m[1] >= threshold]
+        matches.sort(key=lambda m: -m[1])
+        return matches[:limit]
+
+    def group(self, file_ids: List[str], threshold: Optional[float] = None) -> Dict[str, Optional[Tuple[str, float]]]:
+        """
+        Assign each file of a batch to an earlier, near-identical file of the batch
+
+        Files are taken in the given order; a file becomes a leader (None)
+        unless it is at least `threshold` similar to an existing leader, in
+        which case it maps to (that leader, similarity). Followers are thus
+        always directly similar to their leader.
+        """
+        threshold = near_duplicate_threshold() if threshold is None else threshold
+        try:
+            signatures = self.signatures(file_ids)
+        except Exception as e:
+            logger.warning("Similarity index read failed: %s", e)
+            signatures = {}
+        buckets: Dict[Tuple[int, int], List[str]] = defaultdict(list)  # leaders by band bucket
+        assigned: Dict[str, Optional[Tuple[str, float]]] = {}
+        for file_id in file_ids:
+            signature = signatures.get(file_id)
+            if signature is None:
+                assigned[file_id] = None
+                continue
+            keys = list(enumerate(band_keys(signature)))
+            best: Optional[Tuple[str, float]] = None
+            for leader in {leader for key in keys for leader in buckets.get(key, [])}:
+                score = similarity(signature, signatures[leader])
+                if score >= threshold and (best is None or score > best[1]):
+                    best = (leader, score)
+            assigned[file_id] = best
+            if best is None:
+                for key in keys:
+                    buckets[key].append(file_id)
+        return assigned
+
+    def clusters(self, threshold: Optional[float] = None, min_size: int = 2) -> List[List[str]]:
+        """
+        Connected groups of near-identical files, largest first
+
+        Within each band bucket, members are compared with the bucket's first
+        file, which keeps large groups of identical copies linear; members
+        that only resemble each other are linked through another band.
+        """
+        threshold = near_duplicate_threshold() if threshold is None else threshold
+        signatures = self.signatures()
+        parent = {file_id: file_id for file_id in signatures}
+
+        def find(x: str) -> str:
+            while parent[x] != x:
+                parent[x] = parent[parent[x]]
+                x = parent[x]
+            return x
+
+        buckets: Dict[Tuple[int, int], List[str]] = defaultdict(list)
+        for file_id, signature in signatures.items():
+            for key in enumerate(band_keys(signature)):
+                buckets[key].append(file_id)
+        for members in buckets.values():
+            first = members[0]
+            for other in members[1:]:
+                if find(first) != find(other) and similarity(signatures[first], signatures[other]) >= threshold:
+                    parent[find(other)] = find(first)
+
+        groups: Dict[str, List[str]] = defaultdict(list)
+        for file_id in signatures:
+            groups[find(file_id)].append(file_id)
+        found = [members for members in groups.values() if len(members) >= min_size]
+        found.sort(key=len, reverse=True)
+        return found
+
+
+_index: Optional[SimilarityIndex] = None
+_index_lock = threading.Lock()
+
+
+def get_similarity_index() -> SimilarityIndex:
+    """Process-wide SimilarityIndex"""
+    global _index
+    if _index is None:
+        with _index_lock:
+            if _index is None:
+                _index = SimilarityIndex()
+    return _index
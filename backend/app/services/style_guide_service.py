@@ -4,7 +4,7 @@ Style guide processing service
 import re
 import hashlib
 from typing import List, Tuple, Dict
-from app.models.core import StyleGuide, StyleGuideRule, ViolationSeverity, Severity
+from app.models.core import StyleGuide, StyleGuideRule, StyleGuideRulePlan, ViolationSeverity, Severity
 
 
 SECTION_HEADER_RE = re.compile(r"^\s*([A-Z][A-Z0-9 _-]{2,})\s*$")
@@ -49,7 +49,17 @@ class StyleGuideProcessor:
         return StyleGuide(
             name=name,
             rules=rules,
-            raw_content=content
+            raw_content=content,
+            plan=self.compile_rule_plan(content)
+        )
+
+    def compile_rule_plan(self, content: str) -> StyleGuideRulePlan:
+        """Decide once per style guide which optional checks it enables"""
+        content_lower = content.lower()
+        return StyleGuideRulePlan(
+            check_magic_numbers=(
+                'magic number' in content_lower or 'const' in content_lower or 'named constant' in content_lower
+            )
         )
 
     def _split_into_sections(self, content: str) -> List[Tuple[str, List[str]]]:
@@ -0,0 +1,64 @@
+"""
+Start-up warm-up of the embedder and the Ollama model
+"""
+import asyncio
+import logging
+import os
+from datetime import datetime
+from typing import Any, Dict, Optional
+from app.services.ollama_service import get_ollama_service
+from app.services.rag_service import get_rag_service
+
+logger = logging.getLogger(__name__)
+
+# Per component: "cold" (not loaded yet), "warming", "ready" or "failed"
+warm_state: Dict[str, Any] = {
+    "embedder": "cold",
+    "ollama": "cold",
+    "started_at": None,
+    "finished_at": None
+}
+
+_task: Optional[asyncio.Task] = None
+
+
+def warmup_enabled() -> bool:
+    return os.getenv("WARMUP_ON_STARTUP", "false").lower() == "true"
+
+
+async def _warm_embedder() -> None:
+    warm_state["embedder"] = "warming"
+    try:
+        await asyncio.to_thread(get_rag_service().warm_up)
+        warm_state["embedder"] = "ready"
+    except Exception as e:
+        logger.warning("Embedder warm-up failed: %s", e)
+        warm_state["embedder"] = "failed"
+
+
+async def _warm_ollama() -> None:
+    warm_state["ollama"] = "warming"
+    warm_state["ollama"] = "ready" if await get_ollama_service().warm_up() else "failed"
+
+
+async def warm_up() -> None:
+    """Load the embedder and the Ollama model side by side"""
+    warm_state["started_at"] = datetime.utcnow().isoformat()
+    await asyncio.gather(_warm_embedder(), _warm_ollama())
+    warm_state["finished_at"] = datetime.utcnow().isoformat()
+
+
+def start_warm_up() -> asyncio.Task:
+    """Run warm_up() in the background (once); requests are served meanwhile"""
+    global _task
+    if _task is None or _task.done():
+        _task = asyncio.create_task(warm_up())
+    return _task
+
+
+def current_state() -> Dict[str, Any]:
+    state = dict(warm_state)
+    # Loaded on demand by a request even without a warm-up
+    if state["embedder"] == "cold" and get_rag_service().loaded:
+        state["embedder"] = "ready"
+    return state
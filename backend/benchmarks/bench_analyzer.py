@@ -0,0 +1,156 @@
+"""
+Analyzer benchmarks on the synthetic corpus
+
+Measures, per corpus size, the formatting rules, the semantic rules and a
+full analyze_file() with the LLM replaced by an instant mock. Reports
+throughput in lines/sec and peak traced memory.
+
+    python -m benchmarks.bench_analyzer                      # 1K, 10K and 100K lines
+    python -m benchmarks.bench_analyzer --sizes 1000,5000 --repeat 5
+    python -m benchmarks.bench_analyzer --save-baseline      # record benchmarks/baseline.json
+    python -m benchmarks.bench_analyzer --check              # exit 1 on a regression
+
+Baselines are machine specific; record them on the machine that runs --check.
+"""
+import argparse
+import asyncio
+import json
+import os
+import sys
+import time
+import tracemalloc
+from typing import Any, Callable, Dict, List, Optional
+
+# Keep the benchmark away from the real caches and from Ollama/ChromaDB
+os.environ.setdefault("ANALYSIS_CACHE_ENABLED", "false")
+os.environ.setdefault("LLM_CACHE_ENABLED", "false")
+
+from app.parsers.cpp_analyzer import CppAnalyzer, basic_rules, semantic_rules
+from app.parsers.cpp_parser import TreeSitterParser
+from app.parsers import native_scan
+from app.parsers.rule_engine import RuleEngine
+from benchmarks.corpus import generate_source
+
+DEFAULT_SIZES = [1_000, 10_000, 100_000]
+BASELINE_PATH = os.path.join(os.path.dirname(__file__), "baseline.json")
+
+
+class MockOllamaService:
+    """Stands in for OllamaService: every comment check succeeds immediately with no findings"""
+    max_concurrency = 4
+
+    def comment_review_config(self) -> Dict[str, Any]:
+        return {"model": "mock"}
+
+    def cached_comment_review(self, unit_text: str) -> Optional[List[Dict[str, Any]]]:
+        return None
+
+    def store_comment_review(self, unit_text: str, findings: List[Dict[str, Any]]) -> None:
+        pass
+
+    async def check_comment_quality(self, code: str, numbered_code: Optional[str] = None) -> Dict[str, Any]:
+        return {"violations": [], "status": "success"}
+
+    async def check_comment_quality_stream(self, code, on_violation, numbered_code=None) -> Dict[str, Any]:
+        return {"violations": [], "status": "success"}
+
+
+def _measure(func: Callable[[], Any], repeat: int) -> Dict[str, float]:
+    """Best wall time over `repeat` runs, and the peak traced memory of one run"""
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.perf_counter()
+        func()
+        best = min(best, time.perf_counter() - start)
+    # Memory is traced in a separate run so tracing overhead stays out of the timings
+    tracemalloc.start()
+    func()
+    _, peak = tracemalloc.get_traced_memory()
+    tracemalloc.stop()
+    return {"seconds": best, "peak_mb": peak / (1024 * 1024)}
+
+
+def run_benchmarks(sizes: List[int], repeat: int, seed: int) -> Dict[str, Dict[str, float]]:
+    analyzer = CppAnalyzer()
+    analyzer.ollama_service = MockOllamaService()
+    parser = TreeSitterParser()
+    engine = RuleEngine()
+    results: Dict[str, Dict[str, float]] = {}
+    print(f"native scanner: {'on' if native_scan.enabled() else 'off'}")
+
+    for size in sizes:
+        source = generate_source(size, seed)
+        lines = source.split("\n")
+        parsed = parser.parse_code(source)
+
+        benches = {
+            "formatting": lambda: engine.run_lines(lines, basic_rules(), parsed, source),
+            "semantic": lambda: engine.run_lines(lines, semantic_rules(True, parsed), parsed, source),
+            "analyze_file": lambda: asyncio.run(analyzer.analyze_file(
+                source, "bench.cpp", "bench.cpp", "Avoid magic numbers.", use_rag=True
+            )),
+        }
+        for name, func in benches.items():
+            stats = _measure(func, repeat)
+            stats["lines_per_sec"] = len(lines) / stats["seconds"] if stats["seconds"] else 0.0
+            key = f"{name}@{size}"
+            results[key] = stats
+            print(f"{key:<24} {stats['lines_per_sec']:>14,.0f} lines/s "
+                  f"{stats['seconds'] * 1000:>10.1f} ms {stats['peak_mb']:>9.1f} MB peak")
+    return results
+
+
+def compare(results: Dict[str, Dict[str, float]], baseline: Dict[str, Dict[str, float]],
+            tolerance: float) -> List[str]:
+    """Benchmarks that are slower or use more memory than baseline by more than `tolerance`"""
+    regressions = []
+    for key, stats in results.items():
+        base = baseline.get(key)
+        if base is None:
+            continue
+        if stats["lines_per_sec"] < base["lines_per_sec"] * (1 - tolerance):
+            regressions.append(f"{key}: {stats['lines_per_sec']:,.0f} lines/s "
+                               f"(baseline {base['lines_per_sec']:,.0f})")
+        if stats["peak_mb"] > base["peak_mb"] * (1 + tolerance) + 1.0:
+            regressions.append(f"{key}: {stats['peak_mb']:.1f} MB peak (baseline {base['peak_mb']:.1f})")
+    return regressions
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--sizes", default=",".join(str(s) for s in DEFAULT_SIZES),
+                        help="comma-separated corpus sizes in lines")
+    parser.add_argument("--repeat", type=int, default=3)
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--baseline", default=BASELINE_PATH)
+    parser.add_argument("--save-baseline", action="store_true", help="write the results as the new baseline")
+    parser.add_argument("--check", action="store_true", help="fail if slower than the baseline")
+    parser.add_argument("--tolerance", type=float, default=0.25,
+                        help="allowed relative slowdown / memory growth before --check fails")
+    args = parser.parse_args()
+
+    sizes = [int(s) for s in args.sizes.split(",") if s]
+    results = run_benchmarks(sizes, max(1, args.repeat), args.seed)
+
+    if args.save_baseline:
+        with open(args.baseline, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+        print(f"Baseline written to {args.baseline}")
+
+    if args.check:
+        if not os.path.exists(args.baseline):
+            print(f"No baseline at {args.baseline}; run with --save-baseline first")
+            return 1
+        with open(args.baseline) as f:
+            regressions = compare(results, json.load(f), args.tolerance)
+        if regressions:
+            print("Performance regressions:")
+            for line in regressions:
+                print(f"  {line}")
+            return 1
+        print("No regressions against baseline")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,167 @@
+"""
+Synthetic C++ corpus for the analyzer benchmarks
+
+Generates deterministic (seeded) student-style sources of a requested size
+with a mix of classes, free functions, nested control flow, comments and
+new/delete pairs, including the kinds of issues the rules look for (leaks,
+magic numbers, NULL, single-line ifs, long lines).
+
+    python -m benchmarks.corpus --lines 10000 --out /tmp/corpus.cpp
+"""
+import argparse
+import random
+from dataclasses import dataclass
+from typing import List
+
+
+@dataclass
+class CorpusProfile:
+    """Knobs for the shape of the generated code"""
+    max_nesting: int = 4            # deepest if/for/while nesting inside a function
+    comment_density: float = 0.2    # probability of a comment before a statement
+    allocation_rate: float = 0.15   # probability of a new (and usually a delete) per statement
+    leak_rate: float = 0.2          # fraction of allocations that are never deleted
+    issue_rate: float = 0.05        # probability of a planted style issue per statement
+
+
+class _Writer:
+    def __init__(self, rng: random.Random, profile: CorpusProfile):
+        self.rng = rng
+        self.profile = profile
+        self.lines: List[str] = []
+        self.counter = 0
+
+    def emit(self, depth: int, text: str) -> None:
+        self.lines.append("    " * depth + text)
+
+    def name(self, prefix: str) -> str:
+        self.counter += 1
+        return f"{prefix}{self.counter}"
+
+    def comment(self, depth: int) -> None:
+        if self.rng.random() < self.profile.comment_density:
+            self.emit(depth, self.rng.choice([
+                "// Update the running total",
+                "// Check the boundary before indexing",
+                "// TODO: handle the empty case",
+                "// increment i",
+                "/* Walk the list and release each node */",
+            ]))
+
+    def statement(self, depth: int, locals_: List[str]) -> None:
+        rng, profile = self.rng, self.profile
+        self.comment(depth)
+        roll = rng.random()
+        if roll < profile.allocation_rate:
+            var = self.name("buffer")
+            size = rng.choice(["count", "16", "size + 1"])
+            if rng.random() < 0.5:
+                self.emit(depth, f"int* {var} = new int[{size}];")
+                if rng.random() >= profile.leak_rate:
+                    self.emit(depth, f"delete[] {var};")
+            else:
+                self.emit(depth, f"Node* {var} = new Node();")
+                if rng.random() >= profile.leak_rate:
+                    self.emit(depth, f"delete {var};")
+        elif roll < profile.allocation_rate + profile.issue_rate:
+            issue = rng.randrange(4)
+            if issue == 0:
+                self.emit(depth, "if (value > 42) value = 42;")
+            elif issue == 1:
+                self.emit(depth, "Node* head = NULL;")
+            elif issue == 2:
+                self.emit(depth, "double rate = total * 1.15 + 500;")
+            else:
+                self.emit(depth, "result = " + " + ".join(f"term{i} * factor{i}" for i in range(30)) + ";")
+        else:
+            var = self.name("value")
+            locals_.append(var)
+            source = rng.choice(locals_[:-1] or ["count"])
+            self.emit(depth, f"int {var} = {source} + {rng.randrange(3)};")
+
+    def block(self, depth: int, budget: int, nesting: int, locals_: List[str]) -> None:
+        """Emit roughly `budget` lines of statements and nested control flow"""
+        start = len(self.lines)
+        while len(self.lines) - start < budget:
+            if nesting < self.profile.max_nesting and self.rng.random() < 0.25:
+                header = self.rng.choice([
+                    "for (int i = 0; i < count; i++) {",
+                    "while (count > 0) {",
+                    "if (count % 2 == 0) {",
+                ])
+                self.emit(depth, header)
+                self.block(depth + 1, max(2, budget // 4), nesting + 1, list(locals_))
+                if header.startswith("while"):
+                    self.emit(depth + 1, "count--;")
+                self.emit(depth, "}")
+            else:
+                self.statement(depth, locals_)
+
+    def function(self, depth: int, budget: int) -> None:
+        name = self.name("computeValue")
+        self.emit(depth, f"int {name}(int count, int size) {{")
+        self.emit(depth + 1, "int total = 0;")
+        self.block(depth + 1, budget, 0, ["total"])
+        self.emit(depth + 1, "return total;")
+        self.emit(depth, "}")
+        self.emit(0, "")
+
+    def klass(self, budget: int) -> None:
+        name = self.name("Container")
+        self.emit(0, "/**")
+        self.emit(0, f" * {name} groups a few helper methods")
+        self.emit(0, " */")
+        self.emit(0, f"class {name} {{")
+        self.emit(0, "public:")
+        self.emit(1, f"{name}() : data_(new int[8]) {{}}")
+        self.emit(1, f"~{name}() {{ delete[] data_; }}")
+        methods = max(1, budget // 40)
+        for _ in range(methods):
+            self.function(1, max(4, budget // methods - 6))
+        self.emit(0, "private:")
+        self.emit(1, "int* data_;")
+        self.emit(0, "};")
+        self.emit(0, "")
+
+
+def generate_source(lines: int, seed: int = 0, profile: CorpusProfile = CorpusProfile()) -> str:
+    """A C++ translation unit of approximately `lines` lines"""
+    writer = _Writer(random.Random(seed), profile)
+    writer.emit(0, "/*")
+    writer.emit(0, " * Synthetic benchmark source")
+    writer.emit(0, " */")
+    writer.emit(0, "#include <iostream>")
+    writer.emit(0, "")
+    writer.emit(0, "struct Node { int value; Node* next; };")
+    writer.emit(0, "")
+    while len(writer.lines) < lines:
+        remaining = lines - len(writer.lines)
+        if writer.rng.random() < 0.3 and remaining > 120:
+            writer.klass(min(remaining, writer.rng.randint(80, 300)))
+        else:
+            writer.function(0, min(max(remaining - 4, 2), writer.rng.randint(10, 60)))
+    return "\n".join(writer.lines) + "\n"
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--lines", type=int, default=1000)
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--nesting", type=int, default=CorpusProfile.max_nesting)
+    parser.add_argument("--comments", type=float, default=CorpusProfile.comment_density)
+    parser.add_argument("--allocations", type=float, default=CorpusProfile.allocation_rate)
+    parser.add_argument("--out", default="-")
+    args = parser.parse_args()
+
+    profile = CorpusProfile(max_nesting=args.nesting, comment_density=args.comments,
+                            allocation_rate=args.allocations)
+    source = generate_source(args.lines, args.seed, profile)
+    if args.out == "-":
+        print(source, end="")
+    else:
+        with open(args.out, "w") as f:
+            f.write(source)
+
+
+if __name__ == "__main__":
+    main()
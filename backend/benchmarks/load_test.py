@@ -0,0 +1,254 @@
+"""
+End-to-end load test: upload + analyze at a given concurrency
+
+Starts a mock Ollama (benchmarks.mock_ollama) and a backend through run.py
+with WORKERS server processes and its own temporary RAG_DATA_PATH, uploads
+a style guide, then has --concurrency clients each upload a generated file
+and analyze it until --files files are done. Reports p50/p99 latency per
+request type and files/sec.
+
+    python -m benchmarks.load_test                                # 100 files, 8 clients, 1 worker
+    python -m benchmarks.load_test --files 500 --concurrency 32 --workers 4
+    python -m benchmarks.load_test --background                   # submit, then poll /results
+    python -m benchmarks.load_test --url http://grader:8000 --style-guide-id <id>
+
+With --url the running deployment is used as is (its own Ollama hosts);
+only the requests are generated here. Every file is distinct, so results
+come from real analyses and not from the result cache.
+"""
+import argparse
+import asyncio
+import json
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+from typing import Dict, List, Optional
+
+import httpx  # installed with ollama
+
+from benchmarks.corpus import generate_source
+from benchmarks.mock_ollama import start_mock_ollama
+
+BACKEND_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+STYLE_GUIDE = """# Load test style guide
+
+## Naming
+- Variables use camelCase
+- Constants use UPPER_CASE
+
+## Formatting
+- Indent with 4 spaces
+- Lines are at most 100 characters
+
+## Comments
+- Every function has a comment describing what it does
+"""
+
+
+def _free_port() -> int:
+    with socket.socket() as sock:
+        sock.bind(("127.0.0.1", 0))
+        return sock.getsockname()[1]
+
+
+def percentile(values: List[float], fraction: float) -> float:
+    """Nearest-rank percentile (0 for no values)"""
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, max(0, int(round(fraction * len(ordered))) - 1))]
+
+
+def start_backend(port: int, workers: int, ollama_url: str, data_dir: str) -> subprocess.Popen:
+    env = dict(
+        os.environ,
+        HOST="127.0.0.1",
+        PORT=str(port),
+        WORKERS=str(workers),
+        RELOAD="false",
+        RAG_DATA_PATH=data_dir,
+        OLLAMA_HOST=ollama_url,
+        OLLAMA_HOSTS="",
+    )
+    return subprocess.Popen(
+        [sys.executable, "run.py"], cwd=BACKEND_DIR, env=env,
+        stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL
+    )
+
+
+async def wait_ready(client: httpx.AsyncClient, process: Optional[subprocess.Popen], timeout: float) -> None:
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        if process is not None and process.poll() is not None:
+            raise RuntimeError(f"Backend exited with status {process.returncode}")
+        try:
+            if (await client.get("/health")).status_code == 200:
+                return
+        except httpx.TransportError:
+            pass
+        await asyncio.sleep(0.5)
+    raise RuntimeError(f"Backend not ready after {timeout:.0f}s")
+
+
+async def upload_style_guide(client: httpx.AsyncClient) -> str:
+    response = await client.post(
+        "/api/rag/upload",
+        files={"file": ("load_test_guide.md", STYLE_GUIDE.encode("utf-8"), "text/markdown")},
+        params={"doc_type": "style_guide"},
+    )
+    response.raise_for_status()
+    return response.json()["id"]
+
+
+class LoadTest:
+    def __init__(self, client: httpx.AsyncClient, args: argparse.Namespace, style_guide_id: str):
+        self.client = client
+        self.args = args
+        self.style_guide_id = style_guide_id
+        self.latencies: Dict[str, List[float]] = {"upload": [], "analyze": [], "file": []}
+        self.errors: Dict[str, int] = {}
+        self._next = 0
+
+    def _error(self, stage: str, detail: str) -> None:
+        key = f"{stage}: {detail}"
+        self.errors[key] = self.errors.get(key, 0) + 1
+
+    async def _analyze(self, file_id: str) -> bool:
+        request = {"file_id": file_id, "style_guide_id": self.style_guide_id,
+                   "use_rag": self.args.use_rag, "background": self.args.background}
+        response = await self.client.post("/api/analysis/analyze", json=request)
+        if response.status_code != 200:
+            self._error("analyze", str(response.status_code))
+            return False
+        if not self.args.background:
+            return True
+
+        # The poll may be served by any worker: this exercises the shared job store
+        analysis_id = response.json()["analysis_id"]
+        while True:
+            response = await self.client.get(f"/api/analysis/results/{analysis_id}")
+            if response.status_code == 200:
+                return True
+            if response.status_code != 202:
+                self._error("results", str(response.status_code))
+                return False
+            await asyncio.sleep(self.args.poll_interval)
+
+    async def _client(self) -> None:
+        while self._next < self.args.files:
+            index = self._next
+            self._next += 1
+            code = generate_source(self.args.lines, seed=self.args.seed + index)
+            start = time.perf_counter()
+            try:
+                response = await self.client.post(
+                    "/api/files/upload", files={"file": (f"load_{index}.cpp", code.encode("utf-8"), "text/plain")}
+                )
+                if response.status_code != 200:
+                    self._error("upload", str(response.status_code))
+                    continue
+                uploaded = time.perf_counter()
+                self.latencies["upload"].append(uploaded - start)
+                if await self._analyze(response.json()["file_id"]):
+                    done = time.perf_counter()
+                    self.latencies["analyze"].append(done - uploaded)
+                    self.latencies["file"].append(done - start)
+            except httpx.HTTPError as e:
+                self._error("transport", type(e).__name__)
+
+    async def run(self) -> float:
+        start = time.perf_counter()
+        await asyncio.gather(*(self._client() for _ in range(self.args.concurrency)))
+        return time.perf_counter() - start
+
+
+def report(test: LoadTest, elapsed: float, llm_requests: Optional[int]) -> Dict:
+    completed = len(test.latencies["file"])
+    summary = {
+        "files": test.args.files,
+        "completed": completed,
+        "concurrency": test.args.concurrency,
+        "workers": test.args.workers if not test.args.url else None,
+        "elapsed_s": round(elapsed, 3),
+        "files_per_s": round(completed / elapsed, 2) if elapsed else 0.0,
+        "latency_s": {
+            name: {"p50": round(percentile(values, 0.50), 4), "p99": round(percentile(values, 0.99), 4)}
+            for name, values in test.latencies.items()
+        },
+        "llm_requests": llm_requests,
+        "errors": test.errors,
+    }
+    print(f"\n{completed}/{test.args.files} files in {elapsed:.1f}s "
+          f"({summary['files_per_s']:.2f} files/s, {test.args.concurrency} clients)")
+    print(f"{'request':<10}{'p50 (s)':>10}{'p99 (s)':>10}")
+    for name, stats in summary["latency_s"].items():
+        print(f"{name:<10}{stats['p50']:>10.3f}{stats['p99']:>10.3f}")
+    if llm_requests is not None:
+        print(f"Mock Ollama served {llm_requests} chat requests")
+    for error, count in sorted(test.errors.items()):
+        print(f"ERROR {error}: {count}")
+    return summary
+
+
+async def run(args: argparse.Namespace) -> int:
+    mock = process = None
+    data_dir = None
+    url = args.url
+    if not url:
+        mock = start_mock_ollama(latency=args.llm_latency)
+        data_dir = tempfile.mkdtemp(prefix="grader-load-")
+        port = _free_port()
+        process = start_backend(port, args.workers, mock.url, data_dir)
+        url = f"http://127.0.0.1:{port}"
+        print(f"Backend at {url} ({args.workers} workers, data in {data_dir}); mock Ollama at {mock.url}")
+
+    limits = httpx.Limits(max_connections=args.concurrency * 2)
+    try:
+        async with httpx.AsyncClient(base_url=url, timeout=args.timeout, limits=limits) as client:
+            await wait_ready(client, process, args.startup_timeout)
+            style_guide_id = args.style_guide_id or await upload_style_guide(client)
+            test = LoadTest(client, args, style_guide_id)
+            elapsed = await test.run()
+    finally:
+        if process is not None:
+            process.terminate()
+            process.wait(timeout=30)
+        if mock is not None:
+            mock.shutdown()
+
+    summary = report(test, elapsed, mock.requests if mock is not None else None)
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(summary, f, indent=2)
+        print(f"Wrote {args.json}")
+    return 1 if test.errors else 0
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--files", type=int, default=100, help="files to upload and analyze")
+    parser.add_argument("--concurrency", type=int, default=8, help="clients in flight")
+    parser.add_argument("--lines", type=int, default=300, help="lines per generated file")
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--workers", type=int, default=1, help="server processes (WORKERS) to start")
+    parser.add_argument("--llm-latency", type=float, default=0.2, help="mock Ollama seconds per request")
+    parser.add_argument("--no-rag", dest="use_rag", action="store_false", help="skip the LLM comment check")
+    parser.add_argument("--background", action="store_true", help="queue analyses and poll for results")
+    parser.add_argument("--poll-interval", type=float, default=0.2)
+    parser.add_argument("--url", default="", help="existing backend to test instead of starting one")
+    parser.add_argument("--style-guide-id", default="", help="style guide to grade against (default: upload one)")
+    parser.add_argument("--timeout", type=float, default=300.0, help="per-request timeout in seconds")
+    parser.add_argument("--startup-timeout", type=float, default=120.0)
+    parser.add_argument("--json", default="", help="also write the summary to this file")
+    args = parser.parse_args()
+    if args.files < 1 or args.concurrency < 1 or args.workers < 1:
+        parser.error("--files, --concurrency and --workers must be at least 1")
+    return asyncio.run(run(args))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,119 @@
+"""
+Mock Ollama server for load tests
+
+Speaks just enough of Ollama's HTTP API for the grader: GET /api/tags lists
+the model, and POST /api/chat answers every prompt, streamed or not, with
+an empty list of issues after a fixed delay. The delay stands in for model
+latency, so the load test measures the grader and not a GPU.
+
+    python -m benchmarks.mock_ollama --port 11500 --latency 0.5
+"""
+import argparse
+import json
+import os
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from typing import Tuple
+
+RESPONSE = "[]"
+
+
+class MockOllamaHandler(BaseHTTPRequestHandler):
+    server_version = "MockOllama/1.0"
+    protocol_version = "HTTP/1.1"
+
+    def log_message(self, format, *args) -> None:
+        pass
+
+    def _send_json(self, payload, status: int = 200) -> None:
+        body = json.dumps(payload).encode("utf-8")
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def do_GET(self) -> None:
+        if self.path == "/api/tags":
+            self._send_json({"models": [{"name": self.server.model}]})
+        else:
+            self._send_json({"error": "not found"}, 404)
+
+    def do_POST(self) -> None:
+        length = int(self.headers.get("Content-Length", 0))
+        request = json.loads(self.rfile.read(length) or b"{}")
+        if self.path != "/api/chat":
+            self._send_json({"error": "not found"}, 404)
+            return
+
+        self.server.count()
+        time.sleep(self.server.latency)
+        final = {
+            "model": request.get("model", self.server.model),
+            "done": True,
+            "prompt_eval_count": 1,
+            "prompt_eval_duration": 1_000_000,
+            "eval_count": 1,
+            "eval_duration": 1_000_000,
+        }
+        if not request.get("stream", True):
+            self._send_json({**final, "message": {"role": "assistant", "content": RESPONSE}})
+            return
+
+        # Newline-delimited JSON chunks, as Ollama streams them
+        chunks = [{"model": final["model"], "done": False, "message": {"role": "assistant", "content": RESPONSE}},
+                  {**final, "message": {"role": "assistant", "content": ""}}]
+        body = b"".join(json.dumps(chunk).encode("utf-8") + b"\n" for chunk in chunks)
+        self.send_response(200)
+        self.send_header("Content-Type", "application/x-ndjson")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+
+class MockOllamaServer(ThreadingHTTPServer):
+    daemon_threads = True
+
+    def __init__(self, address: Tuple[str, int], latency: float, model: str):
+        super().__init__(address, MockOllamaHandler)
+        self.latency = latency
+        self.model = model
+        self.requests = 0
+        self._lock = threading.Lock()
+
+    def count(self) -> None:
+        with self._lock:
+            self.requests += 1
+
+    @property
+    def url(self) -> str:
+        host, port = self.server_address[:2]
+        return f"http://{host}:{port}"
+
+
+def start_mock_ollama(port: int = 0, latency: float = 0.2, model: str = "") -> MockOllamaServer:
+    """Serve a mock Ollama on a background thread (port 0 picks a free port)"""
+    server = MockOllamaServer(("127.0.0.1", port), latency, model or os.getenv("OLLAMA_MODEL", "codellama:7b"))
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    return server
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=11500)
+    parser.add_argument("--latency", type=float, default=0.2, help="seconds per chat request")
+    parser.add_argument("--model", default="", help="model name to list (default: OLLAMA_MODEL or codellama:7b)")
+    args = parser.parse_args()
+
+    server = start_mock_ollama(args.port, args.latency, args.model)
+    print(f"Mock Ollama at {server.url} ({args.latency:.2f}s per request); CTRL+C to stop")
+    try:
+        while True:
+            time.sleep(3600)
+    except KeyboardInterrupt:
+        server.shutdown()
+
+
+if __name__ == "__main__":
+    main()
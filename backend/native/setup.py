@@ -0,0 +1,28 @@
+"""
+Build the optional compiled Tier 1 scanner (app.parsers._tier1_native)
+
+Run from the backend directory:
+
+    python native/setup.py build_ext --inplace
+
+Only a C++17 compiler and the Python headers are needed. Without the
+module the analyzer uses the pure-Python rules, with the same results.
+"""
+import os
+
+from setuptools import Extension, setup
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+setup(
+    name="tier1-native",
+    version="1.0.0",
+    ext_modules=[
+        Extension(
+            "app.parsers._tier1_native",
+            sources=[os.path.relpath(os.path.join(HERE, "tier1_scan.cpp"))],
+            language="c++",
+            extra_compile_args=["-std=c++17", "-O2"] if os.name != "nt" else ["/std:c++17", "/O2"],
+        )
+    ],
+)
@@ -0,0 +1,584 @@
+/*
+ * tier1_scan.cpp
+ *
+ * Compiled single-pass scanner for the Tier 1 line rules
+ * (app/parsers/rules.py). Each rule here mirrors the visit()/finish() logic
+ * of its Python counterpart exactly; the module only works on the raw
+ * buffer and hands back compact records, and the Python rules turn those
+ * into Violations so descriptions and severities live in one place.
+ *
+ * Sources are expected to be ASCII (native_scan.py checks this), which
+ * keeps Python's str.strip(), \s, \w, \d and \b semantics byte-for-byte.
+ *
+ *     _tier1_native.scan(source: str, specs: list[tuple[str, int]])
+ *         -> (total_lines, block_comment_lines, records)
+ *
+ * where specs are (rule kind, integer parameter) pairs and each record is
+ * (spec index, report kind, line number, a, b, detail, snippet).
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using std::string_view;
+
+// --- Character classes (ASCII subset of the Python semantics) ---
+
+// str.isspace() / regex \s; includes the \x1c-\x1f separators
+inline bool is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r') || (c >= '\x1c' && c <= '\x1f');
+}
+
+inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+inline bool is_word(char c) {
+    return is_digit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+string_view strip(string_view s) {
+    size_t start = 0, end = s.size();
+    while (start < end && is_space(s[start])) start++;
+    while (end > start && is_space(s[end - 1])) end--;
+    return s.substr(start, end - start);
+}
+
+string_view rstrip(string_view s) {
+    size_t end = s.size();
+    while (end > 0 && is_space(s[end - 1])) end--;
+    return s.substr(0, end);
+}
+
+inline bool starts_with(string_view s, string_view prefix) {
+    return s.substr(0, prefix.size()) == prefix;
+}
+
+inline bool ends_with(string_view s, string_view suffix) {
+    return s.size() >= suffix.size() && s.substr(s.size() - suffix.size()) == suffix;
+}
+
+inline bool contains(string_view s, string_view needle) {
+    return s.find(needle) != string_view::npos;
+}
+
+// \b at position i of s
+inline bool word_boundary(string_view s, size_t i) {
+    bool before = i > 0 && is_word(s[i - 1]);
+    bool after = i < s.size() && is_word(s[i]);
+    return before != after;
+}
+
+size_t skip_spaces(string_view s, size_t i) {
+    while (i < s.size() && is_space(s[i])) i++;
+    return i;
+}
+
+// --- Line records (rule_engine.scan_lines) ---
+
+bool ends_in_block_comment(string_view text, bool in_block) {
+    size_t i = 0;
+    while (true) {
+        if (in_block) {
+            size_t end = text.find("*/", i);
+            if (end == string_view::npos) return true;
+            i = end + 2;
+            in_block = false;
+        } else {
+            size_t start = text.find("/*", i);
+            size_t line_comment = text.find("//", i);
+            if (start == string_view::npos || (line_comment != string_view::npos && line_comment < start)) {
+                return false;
+            }
+            i = start + 2;
+            in_block = true;
+        }
+    }
+}
+
+struct Line {
+    long number;
+    string_view text;
+    string_view stripped;
+    size_t indent_width;
+    size_t leading_tabs;
+    size_t leading_spaces;
+    bool is_blank;
+    bool is_comment;
+    bool in_block_comment;
+    bool is_preprocessor;
+    long opens;
+    long closes;
+};
+
+std::vector<Line> scan_lines(string_view source) {
+    std::vector<Line> lines;
+    lines.reserve(std::count(source.begin(), source.end(), '\n') + 1);
+    bool in_block = false;
+    size_t start = 0;
+    long number = 0;
+    while (true) {
+        size_t end = source.find('\n', start);
+        string_view text = source.substr(start, end == string_view::npos ? string_view::npos : end - start);
+        Line line{};
+        line.number = ++number;
+        line.text = text;
+        line.stripped = strip(text);
+        line.in_block_comment = in_block;
+        if (in_block || contains(line.stripped, "/*")) {
+            in_block = ends_in_block_comment(line.stripped, in_block);
+        }
+        size_t i = 0;
+        while (i < text.size() && is_space(text[i])) i++;
+        line.indent_width = i;
+        for (i = 0; i < text.size() && text[i] == '\t'; i++) {}
+        line.leading_tabs = i;
+        for (i = 0; i < text.size() && text[i] == ' '; i++) {}
+        line.leading_spaces = i;
+        line.is_blank = line.stripped.empty();
+        line.is_comment = line.in_block_comment || starts_with(line.stripped, "//")
+                          || starts_with(line.stripped, "/*") || starts_with(line.stripped, "*");
+        line.is_preprocessor = starts_with(line.stripped, "#");
+        line.opens = std::count(line.stripped.begin(), line.stripped.end(), '{');
+        line.closes = std::count(line.stripped.begin(), line.stripped.end(), '}');
+        lines.push_back(line);
+        if (end == string_view::npos) break;
+        start = end + 1;
+    }
+    return lines;
+}
+
+// --- Records ---
+
+struct Record {
+    long spec;
+    int kind;
+    long line;
+    long a;
+    long b;
+    std::string detail;
+    bool has_detail;
+    string_view snippet;
+    bool has_snippet;
+    bool ellipsis;  // append "..." to the snippet
+};
+
+class Rule {
+public:
+    explicit Rule(long spec) : spec_(spec) {}
+    virtual ~Rule() = default;
+    virtual void visit(const Line& line, const Line* next) = 0;
+    virtual void finish(long /*total_lines*/) {}
+
+    std::vector<Record> records;
+
+protected:
+    Record& report(int kind, long line, long a = 0, long b = 0) {
+        records.push_back(Record{spec_, kind, line, a, b, std::string(), false, string_view(), false, false});
+        return records.back();
+    }
+
+    static void snippet(Record& record, string_view text, bool ellipsis = false) {
+        record.snippet = text;
+        record.has_snippet = true;
+        record.ellipsis = ellipsis;
+    }
+
+private:
+    long spec_;
+};
+
+// IndentationRule: kind 0 improper_indentation (a=current, b=expected), kind 1 mixed_indentation
+class IndentationRule : public Rule {
+public:
+    using Rule::Rule;
+
+    void visit(const Line& line, const Line*) override {
+        if (mixed_) return;
+
+        if (!line.is_blank && line.indent_width > 0) {
+            char leading = line.text[0];
+            if (leading == '\t') {
+                if (uses_tabs_ == 0) { mixed_ = true; return; }
+                uses_tabs_ = 1;
+            } else if (leading == ' ') {
+                if (uses_tabs_ == 1) { mixed_ = true; return; }
+                uses_tabs_ = 0;
+            }
+        }
+
+        string_view stripped = line.stripped;
+        if (line.is_blank || line.is_preprocessor) return;
+
+        long current = uses_tabs_ == 1 ? long(line.leading_tabs) : long(line.leading_spaces / 4);
+
+        if (contains(stripped, "switch") && line.opens) in_switch_ = true;
+
+        bool closes_first = starts_with(stripped, "}");
+        if (closes_first) {
+            expected_ = std::max(0L, expected_ - 1);
+            in_switch_ = false;
+        }
+
+        if (current != expected_ && !closes_first) {
+            bool is_label = ends_with(stripped, ":");
+            bool is_case_related = starts_with(stripped, "case ") || starts_with(stripped, "default");
+            bool is_inside_switch = in_switch_ && (current == expected_ + 1 || is_case_related);
+            if (!(is_label || is_inside_switch)) {
+                snippet(report(0, line.number, current, expected_), rstrip(line.text));
+            }
+        }
+
+        if (line.opens && !closes_first) expected_ += line.opens - line.closes;
+    }
+
+    void finish(long) override {
+        if (mixed_) {
+            records.clear();
+            report(1, 1);
+        } else if (uses_tabs_ < 0) {
+            records.clear();
+        }
+    }
+
+private:
+    int uses_tabs_ = -1;
+    bool mixed_ = false;
+    long expected_ = 0;
+    bool in_switch_ = false;
+};
+
+// LineLengthRule: a=length
+class LineLengthRule : public Rule {
+public:
+    LineLengthRule(long spec, long max_length) : Rule(spec), max_length_(max_length) {}
+
+    void visit(const Line& line, const Line*) override {
+        long length = long(line.text.size());
+        if (length > max_length_) {
+            Record& record = report(0, line.number, length);
+            if (length > 100) {
+                snippet(record, line.text.substr(0, 100), true);
+            } else {
+                snippet(record, line.text);
+            }
+        }
+    }
+
+private:
+    long max_length_;
+};
+
+// SingleLineIfRule: ^\s*(if|else\s+if|for|while)\s*\(
+class SingleLineIfRule : public Rule {
+public:
+    using Rule::Rule;
+
+    void visit(const Line& line, const Line* next) override {
+        string_view text = line.text;
+        size_t open = keyword_paren(text);
+        if (open == string_view::npos) return;
+
+        long depth = 0;
+        size_t paren_end = string_view::npos;
+        for (size_t pos = open; pos < text.size(); pos++) {
+            if (text[pos] == '(') {
+                depth++;
+            } else if (text[pos] == ')') {
+                depth--;
+                if (depth == 0) { paren_end = pos; break; }
+            }
+        }
+        if (paren_end == string_view::npos) return;
+
+        string_view remainder = strip(text.substr(paren_end + 1));
+        if (starts_with(remainder, "{")) return;
+
+        if (!remainder.empty() && !starts_with(remainder, "//")) {
+            snippet(report(0, line.number), line.stripped);
+        } else if (next != nullptr) {
+            string_view next_stripped = next->stripped;
+            if (!next_stripped.empty() && !starts_with(next_stripped, "{") && !starts_with(next_stripped, "//")) {
+                snippet(report(0, line.number), line.stripped);
+            }
+        }
+    }
+
+private:
+    // Position of the '(' after the keyword, or npos when the line does not match
+    static size_t keyword_paren(string_view text) {
+        size_t i = skip_spaces(text, 0);
+        string_view rest = text.substr(i);
+        size_t after = string_view::npos;
+        if (starts_with(rest, "if")) {
+            after = i + 2;
+        } else if (starts_with(rest, "else") && i + 4 < text.size() && is_space(text[i + 4])) {
+            size_t j = skip_spaces(text, i + 4);
+            if (starts_with(text.substr(j), "if")) after = j + 2;
+        }
+        if (after == string_view::npos) {
+            if (starts_with(rest, "for")) {
+                after = i + 3;
+            } else if (starts_with(rest, "while")) {
+                after = i + 5;
+            } else {
+                return string_view::npos;
+            }
+        }
+        size_t j = skip_spaces(text, after);
+        return j < text.size() && text[j] == '(' ? j : string_view::npos;
+    }
+};
+
+// FileHeaderCommentRule / NoCommentsRule: a comment within (or after) the first 10 lines
+class CommentPresenceRule : public Rule {
+public:
+    CommentPresenceRule(long spec, bool header, long report_line)
+        : Rule(spec), header_(header), report_line_(report_line) {}
+
+    void visit(const Line& line, const Line*) override {
+        bool in_header = line.number <= 10;
+        if (in_header == header_ && line.is_comment) found_ = true;
+    }
+
+    void finish(long) override {
+        if (!found_) report(0, report_line_);
+    }
+
+private:
+    bool header_;
+    long report_line_;
+    bool found_ = false;
+};
+
+// MagicNumberRule: detail=the number
+class MagicNumberRule : public Rule {
+public:
+    using Rule::Rule;
+
+    void visit(const Line& line, const Line*) override {
+        if (line.is_comment || line.is_preprocessor) return;
+        string_view s = line.stripped;
+
+        bool headers_found = false;
+        std::vector<string_view> headers;
+        size_t p = 0;
+        while (p < s.size()) {
+            size_t end = match_number(s, p);
+            if (end == string_view::npos) { p++; continue; }
+            string_view num = s.substr(p, end - p);
+            p = end;
+            if (num == "0" || num == "1") continue;
+
+            if (!headers_found) {
+                loop_headers(s, headers);
+                headers_found = true;
+            }
+            bool in_header = false;
+            for (string_view header : headers) {
+                if (contains(header, num)) { in_header = true; break; }
+            }
+            if (in_header) continue;
+
+            std::string indexed = "[" + std::string(num) + "]";
+            if (contains(s, indexed)) continue;
+
+            Record& record = report(0, line.number);
+            record.detail = std::string(num);
+            record.has_detail = true;
+            snippet(record, s);
+            break;
+        }
+    }
+
+private:
+    // End of a \b(\d+\.?\d*)\b match starting at p, with the regex's backtracking order
+    static size_t match_number(string_view s, size_t p) {
+        if (!is_digit(s[p]) || !word_boundary(s, p)) return string_view::npos;
+        size_t digits_end = p;
+        while (digits_end < s.size() && is_digit(s[digits_end])) digits_end++;
+        for (size_t k = digits_end; k > p; k--) {
+            size_t starts[2];
+            int options = 0;
+            if (k < s.size() && s[k] == '.') starts[options++] = k + 1;
+            starts[options++] = k;
+            for (int o = 0; o < options; o++) {
+                size_t q = starts[o];
+                size_t last = q;
+                while (last < s.size() && is_digit(s[last])) last++;
+                for (size_t e = last + 1; e-- > q;) {
+                    if (word_boundary(s, e)) return e;
+                }
+            }
+        }
+        return string_view::npos;
+    }
+
+    // Group 2 of every (for|while)\s*\(([^)]*) match
+    static void loop_headers(string_view s, std::vector<string_view>& headers) {
+        size_t p = 0;
+        while (p < s.size()) {
+            string_view rest = s.substr(p);
+            size_t kw = starts_with(rest, "for") ? 3 : starts_with(rest, "while") ? 5 : 0;
+            if (kw) {
+                size_t i = skip_spaces(s, p + kw);
+                if (i < s.size() && s[i] == '(') {
+                    size_t close = s.find(')', i + 1);
+                    size_t end = close == string_view::npos ? s.size() : close;
+                    headers.push_back(s.substr(i + 1, end - i - 1));
+                    p = end > p ? end : p + 1;
+                    continue;
+                }
+            }
+            p++;
+        }
+    }
+};
+
+// NullVsNullptrRule: \bNULL\b
+class NullRule : public Rule {
+public:
+    using Rule::Rule;
+
+    void visit(const Line& line, const Line*) override {
+        if (line.is_comment || line.is_preprocessor) return;
+        string_view s = line.stripped;
+        for (size_t p = s.find("NULL"); p != string_view::npos; p = s.find("NULL", p + 1)) {
+            if (word_boundary(s, p) && word_boundary(s, p + 4)) {
+                snippet(report(0, line.number), s);
+                return;
+            }
+        }
+    }
+};
+
+// One kind per rule in rules.py that sets `native`: IndentationRule,
+// LineLengthRule, SingleLineIfRule, FileHeaderCommentRule, NoCommentsRule,
+// MagicNumberRule and NullVsNullptrRule
+std::unique_ptr<Rule> make_rule(string_view kind, long spec, long param) {
+    if (kind == "indentation") return std::make_unique<IndentationRule>(spec);
+    if (kind == "line_length") return std::make_unique<LineLengthRule>(spec, param);
+    if (kind == "single_line_if") return std::make_unique<SingleLineIfRule>(spec);
+    if (kind == "file_header") return std::make_unique<CommentPresenceRule>(spec, true, 1);
+    if (kind == "no_comments") return std::make_unique<CommentPresenceRule>(spec, false, 11);
+    if (kind == "magic_numbers") return std::make_unique<MagicNumberRule>(spec);
+    if (kind == "null_vs_nullptr") return std::make_unique<NullRule>(spec);
+    return nullptr;
+}
+
+PyObject* snippet_object(const Record& record) {
+    if (!record.has_snippet) Py_RETURN_NONE;
+    if (!record.ellipsis) {
+        return PyUnicode_FromStringAndSize(record.snippet.data(), Py_ssize_t(record.snippet.size()));
+    }
+    std::string text(record.snippet);
+    text += "...";
+    return PyUnicode_FromStringAndSize(text.data(), Py_ssize_t(text.size()));
+}
+
+PyObject* record_object(const Record& record) {
+    PyObject* detail = record.has_detail
+        ? PyUnicode_FromStringAndSize(record.detail.data(), Py_ssize_t(record.detail.size()))
+        : (Py_INCREF(Py_None), Py_None);
+    PyObject* snippet = snippet_object(record);
+    if (detail == nullptr || snippet == nullptr) {
+        Py_XDECREF(detail);
+        Py_XDECREF(snippet);
+        return nullptr;
+    }
+    // "N" steals the references to detail and snippet
+    return Py_BuildValue("(liillNN)", record.spec, record.kind, record.line, record.a, record.b, detail, snippet);
+}
+
+PyObject* scan(PyObject*, PyObject* args) {
+    PyObject* source_obj;
+    PyObject* specs;
+    if (!PyArg_ParseTuple(args, "UO:scan", &source_obj, &specs)) return nullptr;
+
+    // For ASCII strings this is the string's own buffer, so nothing is copied
+    Py_ssize_t size;
+    const char* data = PyUnicode_AsUTF8AndSize(source_obj, &size);
+    if (data == nullptr) return nullptr;
+
+    PyObject* spec_seq = PySequence_Fast(specs, "specs must be a sequence");
+    if (spec_seq == nullptr) return nullptr;
+    std::vector<std::unique_ptr<Rule>> rules;
+    Py_ssize_t count = PySequence_Fast_GET_SIZE(spec_seq);
+    for (Py_ssize_t i = 0; i < count; i++) {
+        const char* kind;
+        long param;
+        if (!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(spec_seq, i), "sl", &kind, &param)) {
+            Py_DECREF(spec_seq);
+            return nullptr;
+        }
+        std::unique_ptr<Rule> rule = make_rule(kind, long(i), param);
+        if (!rule) {
+            Py_DECREF(spec_seq);
+            PyErr_Format(PyExc_ValueError, "unknown rule kind '%s'", kind);
+            return nullptr;
+        }
+        rules.push_back(std::move(rule));
+    }
+    Py_DECREF(spec_seq);
+
+    std::vector<Line> lines;
+    Py_BEGIN_ALLOW_THREADS
+    lines = scan_lines(string_view(data, size_t(size)));
+    for (size_t i = 0; i < lines.size(); i++) {
+        const Line* next = i + 1 < lines.size() ? &lines[i + 1] : nullptr;
+        for (auto& rule : rules) rule->visit(lines[i], next);
+    }
+    for (auto& rule : rules) rule->finish(long(lines.size()));
+    Py_END_ALLOW_THREADS
+
+    PyObject* block_lines = PyList_New(0);
+    PyObject* records = PyList_New(0);
+    if (block_lines == nullptr || records == nullptr) goto error;
+    for (const Line& line : lines) {
+        if (!line.in_block_comment) continue;
+        PyObject* number = PyLong_FromLong(line.number);
+        if (number == nullptr || PyList_Append(block_lines, number) < 0) {
+            Py_XDECREF(number);
+            goto error;
+        }
+        Py_DECREF(number);
+    }
+    for (auto& rule : rules) {
+        for (const Record& record : rule->records) {
+            PyObject* item = record_object(record);
+            if (item == nullptr || PyList_Append(records, item) < 0) {
+                Py_XDECREF(item);
+                goto error;
+            }
+            Py_DECREF(item);
+        }
+    }
+    return Py_BuildValue("(nNN)", Py_ssize_t(lines.size()), block_lines, records);
+
+error:
+    Py_XDECREF(block_lines);
+    Py_XDECREF(records);
+    return nullptr;
+}
+
+PyMethodDef methods[] = {
+    {"scan", scan, METH_VARARGS, "Run the Tier 1 line rules over a source string in one pass"},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyModuleDef module = {
+    PyModuleDef_HEAD_INIT, "_tier1_native", "Compiled scanner for the Tier 1 line rules", -1, methods,
+    nullptr, nullptr, nullptr, nullptr,
+};
+
+}  // namespace
+
+PyMODINIT_FUNC PyInit__tier1_native() {
+    return PyModule_Create(&module);
+}
@@ -1,5 +1,9 @@
 """
 Convenience script to run the backend server
+
+WORKERS=N starts N server processes on the same port (no auto-reload).
+Uploads, style guides, caches and background job statuses live in the
+on-disk stores under RAG_DATA_PATH, so any worker can serve any request.
 """
 import os
 
@@ -33,13 +37,19 @@ except ModuleNotFoundError:
 if __name__ == "__main__":
     host = os.getenv("HOST", "0.0.0.0")
     port = int(os.getenv("PORT", 8000))
+    workers = max(1, int(os.getenv("WORKERS", "1")))
+    # Auto-reload only works with a single process
+    reload = workers == 1 and os.getenv("RELOAD", "true").lower() != "false"
+    if workers > 1 and os.getenv("BATCH_WORKERS", "0") == "0":
+        # Each server process has its own batch pool; share the cores between them
+        os.environ["BATCH_WORKERS"] = str(max(1, (os.cpu_count() or 1) // workers))
 
     print(f"""
 ==============================================
   Code Style Grader - Backend Server
 ==============================================
 
-Starting server at http://{host}:{port}
+Starting server at http://{host}:{port} ({workers} worker process{'es' if workers > 1 else ''})
 
 API Documentation:
 - Swagger UI: http://localhost:{port}/docs
@@ -52,6 +62,7 @@ Press CTRL+C to stop the server
         "app.main:app",
         host=host,
         port=port,
-        reload=True,
+        reload=reload,
+        workers=workers,
         log_level="info"
     )
@@ -0,0 +1,58 @@
+"""
+Incremental reparsing must leave the stored snapshot's tree untouched
+
+    python -m pytest tests        # from backend/
+"""
+import asyncio
+
+import pytest
+
+pytest.importorskip("tree_sitter_cpp")
+
+from app.parsers.cpp_analyzer import CppAnalyzer
+from app.parsers.incremental import diff_lines
+
+OLD = "int add(int a, int b) {\n    return a + b;\n}\n"
+NEW = "int add(int a, int b) {\n    int sum = a + b;\n    return sum;\n}\n"
+OTHER = "// header\nint add(int a, int b) {\n    return b + a;\n}\n"
+
+
+@pytest.fixture
+def analyzer(tmp_path, monkeypatch):
+    monkeypatch.setenv("RAG_DATA_PATH", str(tmp_path))
+    monkeypatch.setenv("ANALYSIS_CACHE_ENABLED", "false")
+    return CppAnalyzer()
+
+
+def _analyze(analyzer, code, previous=None):
+    return asyncio.run(analyzer.analyze_revision(code, "add.cpp", "add.cpp", "", False, previous=previous))
+
+
+def test_reparse_does_not_edit_the_previous_tree(analyzer):
+    parser = analyzer.tree_sitter_parser
+    previous = parser.parse_code(OLD)
+    before = str(previous.tree.root_node)
+
+    parser.reparse(previous, NEW, diff_lines(OLD.split("\n"), NEW.split("\n")).hunks)
+
+    assert str(previous.tree.root_node) == before
+    assert previous.tree.root_node.end_byte == len(OLD.encode("utf-8"))
+
+
+def test_failed_analysis_keeps_a_usable_snapshot(analyzer, monkeypatch):
+    _, snapshot = _analyze(analyzer, OLD)
+    assert snapshot is not None and snapshot.parsed is not None
+
+    # Fail after the reparse, as a rule error would
+    def fail(*args, **kwargs):
+        raise RuntimeError("rule failure")
+    with monkeypatch.context() as patch:
+        patch.setattr(analyzer.rule_engine, "run_lines", fail)
+        result, failed = _analyze(analyzer, NEW, previous=snapshot)
+    assert result.status == "error" and failed is None
+
+    # The caller keeps the old snapshot; reparsing from it again must match a fresh parse
+    hunks = diff_lines(OLD.split("\n"), OTHER.split("\n")).hunks
+    reparsed = analyzer.tree_sitter_parser.reparse(snapshot.parsed, OTHER, hunks)
+    fresh = analyzer.tree_sitter_parser.parse_code(OTHER)
+    assert str(reparsed.tree.root_node) == str(fresh.tree.root_node)
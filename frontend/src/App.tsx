@@ -2,18 +2,36 @@ import React, { useEffect, useState, useMemo, useRef } from 'react';
 import FileUploader from './components/FileUploader';
 import CodeViewer from './components/CodeViewer';
 import ViolationPanel from './components/ViolationPanel';
-import { AnalysisResult, UploadedFile, FileTreeNode } from './types';
-import { analyzeCode, listRAGDocuments, uploadRAGDocument } from './services/api';
+import { AnalysisResult, UploadedFile, FileTreeNode, StreamedViolationCounts, Violation } from './types';
+import { analyzeCodeStream, listRAGDocuments, uploadRAGDocument } from './services/api';
 import { buildFileTree, removeFileFromTree } from './utils/fileTreeUtils';
 import {
-  saveUploadedFiles,
-  loadUploadedFiles,
-  saveAnalysisResults,
-  loadAnalysisResults,
+  isIndexedDbAvailable,
+  loadStoredFiles,
+  loadStoredResults,
+  saveStoredFiles,
+  saveStoredResults
+} from './utils/indexedDbStore';
+import {
   saveSelectedFileId,
-  loadSelectedFileId
+  loadSelectedFileId,
+  takeLegacyPersistedData
 } from './utils/localStorage';
 
+// Fold streamed violations into the partial result shown while analysis runs.
+// The summary counts are the backend's running totals, not re-derived here.
+const appendViolations = (
+  result: AnalysisResult,
+  violations: Violation[],
+  counts: StreamedViolationCounts
+): AnalysisResult => ({
+  ...result,
+  violations: [...result.violations, ...violations],
+  total_violations: result.total_violations + violations.length,
+  violations_by_severity: counts.violations_by_severity,
+  violations_by_type: counts.violations_by_type,
+});
+
 function App() {
   const [uploadedFiles, setUploadedFiles] = useState<UploadedFile[]>([]);
   const [selectedFile, setSelectedFile] = useState<UploadedFile | null>(null);
@@ -24,21 +42,52 @@ function App() {
   const [analyzing, setAnalyzing] = useState<boolean>(false);
   const [analysisError, setAnalysisError] = useState<string | null>(null);
   const styleGuideInputRef = useRef<HTMLInputElement>(null);
+  const selectedFileIdRef = useRef<string | null>(null);
+  // What IndexedDB holds; null until the saved state has been restored
+  const persistedFilesRef = useRef<UploadedFile[] | null>(null);
+  const persistedResultsRef = useRef<Record<string, AnalysisResult> | null>(null);
 
   // Build file tree from flat list
   const fileTree = useMemo(() => buildFileTree(uploadedFiles), [uploadedFiles]);
 
-  // Load persisted data on mount
+  // Load persisted data on mount. IndexedDB is asynchronous, so anything
+  // uploaded or analyzed before it finishes is merged with what was saved.
   useEffect(() => {
-    const savedFiles = loadUploadedFiles();
-    const savedResults = loadAnalysisResults();
+    let cancelled = false;
     const savedSelectedId = loadSelectedFileId();
 
-    if (savedFiles.length > 0) {
-      setUploadedFiles(savedFiles);
-      setAnalysisResults(savedResults);
+    const restore = async () => {
+      let savedFiles = await loadStoredFiles();
+      let savedResults = await loadStoredResults();
+
+      // One-time move of data saved by older versions to sessionStorage
+      if (isIndexedDbAvailable()) {
+        const legacy = takeLegacyPersistedData();
+        if (legacy.files.length > 0 && savedFiles.length === 0) {
+          await saveStoredFiles(legacy.files, []);
+          await saveStoredResults(legacy.results, []);
+          savedFiles = legacy.files;
+          savedResults = legacy.results;
+        }
+      }
+      if (cancelled) {
+        return;
+      }
+
+      persistedFilesRef.current = savedFiles;
+      persistedResultsRef.current = savedResults;
+      // New arrays even when nothing was saved, so the persist effects run
+      const savedIds = new Set(savedFiles.map(f => (f as any).id || (f as any).file_id));
+      setUploadedFiles(prev => [
+        ...savedFiles,
+        ...prev.filter(f => !savedIds.has((f as any).id || (f as any).file_id)),
+      ]);
+      setAnalysisResults(prev => ({ ...savedResults, ...prev }));
 
-      // Restore selected file
+      // Restore selected file unless the user already picked one
+      if (selectedFileIdRef.current || savedFiles.length === 0) {
+        return;
+      }
       if (savedSelectedId) {
         const file = savedFiles.find(f => {
           const id = (f as any).id || (f as any).file_id;
@@ -49,25 +98,53 @@ function App() {
           const result = savedResults[savedSelectedId] || null;
           setAnalysisResult(result);
         }
-      } else if (savedFiles.length > 0) {
+      } else {
         setSelectedFile(savedFiles[0]);
       }
-    }
+    };
+
+    restore();
+    return () => {
+      cancelled = true;
+    };
   }, []);
 
-  // Persist uploaded files whenever they change
+  // Persist uploaded files whenever they change, writing only the files
+  // added, replaced or removed since the last save
   useEffect(() => {
-    saveUploadedFiles(uploadedFiles);
+    const persisted = persistedFilesRef.current;
+    if (!persisted) {
+      return; // Not restored yet
+    }
+    const previous = new Map(persisted.map(f => [(f as any).id || (f as any).file_id, f]));
+    const currentIds = new Set(uploadedFiles.map(f => (f as any).id || (f as any).file_id));
+    const changed = uploadedFiles.filter(f => previous.get((f as any).id || (f as any).file_id) !== f);
+    const removed = Array.from(previous.keys()).filter(id => !currentIds.has(id));
+    persistedFilesRef.current = uploadedFiles;
+    saveStoredFiles(changed, removed);
   }, [uploadedFiles]);
 
-  // Persist analysis results whenever they change
+  // Persist analysis results whenever they change, one record per file
   useEffect(() => {
-    saveAnalysisResults(analysisResults);
+    const persisted = persistedResultsRef.current;
+    if (!persisted) {
+      return; // Not restored yet
+    }
+    const changed: Record<string, AnalysisResult> = {};
+    Object.entries(analysisResults).forEach(([id, result]) => {
+      if (persisted[id] !== result) {
+        changed[id] = result;
+      }
+    });
+    const removed = Object.keys(persisted).filter(id => !(id in analysisResults));
+    persistedResultsRef.current = analysisResults;
+    saveStoredResults(changed, removed);
   }, [analysisResults]);
 
   // Persist selected file ID whenever it changes
   useEffect(() => {
     const fileId = selectedFile ? ((selectedFile as any).id || (selectedFile as any).file_id) : null;
+    selectedFileIdRef.current = fileId;
     saveSelectedFileId(fileId);
   }, [selectedFile]);
 
@@ -168,15 +245,47 @@ function App() {
     setAnalyzing(true);
     try {
       const fileId = (selectedFile as any).id ?? (selectedFile as any).file_id;
-      const result = await analyzeCode(fileId, selectedGuideId, true); // Always use RAG
+
+      // Show violations as they stream in; the final result replaces this
+      let partial: AnalysisResult = {
+        file_name: selectedFile.file_name,
+        file_path: selectedFile.file_name,
+        timestamp: new Date().toISOString(),
+        violations: [],
+        total_violations: 0,
+        violations_by_severity: {},
+        violations_by_type: {},
+        status: 'running',
+        streaming: true,
+      };
+      const showPartial = () => {
+        // The user may have switched files while the analysis streams
+        if (selectedFileIdRef.current === fileId) {
+          setAnalysisResult(partial);
+        }
+      };
+      showPartial();
+
+      const result = await analyzeCodeStream(fileId, selectedGuideId, true, { // Always use RAG
+        onStage: stage => {
+          partial = { ...partial, stage };
+          showPartial();
+        },
+        onViolations: (_stage, violations, counts) => {
+          partial = appendViolations(partial, violations, counts);
+          showPartial();
+        },
+      });
 
       // Update current analysis result
-      setAnalysisResult(result as any);
+      if (selectedFileIdRef.current === fileId) {
+        setAnalysisResult(result);
+      }
 
       // Save result associated with this file
       setAnalysisResults(prev => ({
         ...prev,
-        [fileId]: result as any
+        [fileId]: result
       }));
     } catch (e: any) {
       setAnalysisError(e?.message || 'Failed to run analysis.');
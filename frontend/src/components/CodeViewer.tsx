@@ -1,9 +1,9 @@
 /**
  * CodeViewer Component - Display code with syntax highlighting using Monaco Editor
  */
-import React, { useEffect, useState, useRef } from 'react';
+import React, { useEffect, useMemo, useState, useRef } from 'react';
 import Editor from '@monaco-editor/react';
-import { UploadedFile, AnalysisResult, ViolationSeverity } from '../types';
+import { UploadedFile, AnalysisResult, Violation, ViolationSeverity } from '../types';
 import * as api from '../services/api';
 import type { editor } from 'monaco-editor';
 
@@ -12,10 +12,113 @@ interface CodeViewerProps {
   analysisResult: AnalysisResult | null;
 }
 
+interface LineDecorations {
+  lineNumber: number;
+  key: string;  // Identifies the line's violations; equal keys mean equal decorations
+  decorations: editor.IModelDeltaDecoration[];
+}
+
+interface AppliedLine {
+  key: string;
+  ids: string[];
+}
+
+const getBorderColor = (sev: ViolationSeverity): string => {
+  switch (sev) {
+    case ViolationSeverity.CRITICAL:
+      return 'rgba(239, 68, 68, 0.6)'; // red
+    case ViolationSeverity.WARNING:
+      return 'rgba(245, 158, 11, 0.6)'; // amber
+    case ViolationSeverity.MINOR:
+      return 'rgba(59, 130, 246, 0.6)'; // blue
+    default:
+      return 'rgba(156, 163, 175, 0.6)'; // gray fallback
+  }
+};
+
+/**
+ * Group violations by line and build each line's highlight decorations
+ */
+const buildLineDecorations = (violationList: Violation[]): Map<number, LineDecorations> => {
+  const violationsByLine = new Map<number, Violation[]>();
+  violationList.forEach(violation => {
+    const line = violation.line_number;
+    if (!violationsByLine.has(line)) {
+      violationsByLine.set(line, []);
+    }
+    violationsByLine.get(line)!.push(violation);
+  });
+
+  const result = new Map<number, LineDecorations>();
+  violationsByLine.forEach((violations, lineNumber) => {
+    // Find the highest severity for this line
+    const severities = violations.map(v => v.severity);
+    let severity: ViolationSeverity;
+
+    if (severities.includes(ViolationSeverity.CRITICAL)) {
+      severity = ViolationSeverity.CRITICAL;
+    } else if (severities.includes(ViolationSeverity.WARNING)) {
+      severity = ViolationSeverity.WARNING;
+    } else {
+      severity = ViolationSeverity.MINOR;
+    }
+
+    const hoverMessage = violations.map(v =>
+      `**${v.severity}**: ${v.description}`
+    ).join('\n\n');
+    const range = {
+      startLineNumber: lineNumber,
+      startColumn: 1,
+      endLineNumber: lineNumber,
+      endColumn: Number.MAX_VALUE,
+    };
+
+    result.set(lineNumber, {
+      lineNumber,
+      key: `${severity}\u0000${hoverMessage}`,
+      decorations: [
+        // Line highlight decoration
+        {
+          range,
+          options: {
+            isWholeLine: true,
+            className: 'violation-line',
+            glyphMarginClassName: 'violation-glyph',
+            glyphMarginHoverMessage: { value: hoverMessage },
+            inlineClassName: 'violation-inline',
+            overviewRuler: {
+              color: getBorderColor(severity),
+              position: 4, // OverviewRulerLane.Full
+            },
+            minimap: {
+              color: getBorderColor(severity),
+              position: 2, // MinimapPosition.Inline
+            },
+          },
+        },
+        // Background decoration
+        {
+          range,
+          options: {
+            isWholeLine: true,
+            className: '',
+            inlineClassName: '',
+            linesDecorationsClassName: `violation-decoration-${severity.toLowerCase()}`,
+          },
+        },
+      ],
+    });
+  });
+  return result;
+};
+
 const CodeViewer: React.FC<CodeViewerProps> = ({ file, analysisResult }) => {
   const [code, setCode] = useState<string>('');
   const [loading, setLoading] = useState(false);
   const editorRef = useRef<editor.IStandaloneCodeEditor | null>(null);
+  const appliedRef = useRef<Map<number, AppliedLine>>(new Map());  // decoration ids by line
+  const appliedCodeRef = useRef<string | null>(null);
+  const [editorMounts, setEditorMounts] = useState(0);
 
   useEffect(() => {
     const loadFileContent = async () => {
@@ -45,125 +148,64 @@ const CodeViewer: React.FC<CodeViewerProps> = ({ file, analysisResult }) => {
     loadFileContent();
   }, [file]);
 
-  // Apply violation highlighting when analysis results change
+  // Decorations for each line, rebuilt only when the violation list changes
+  const lineDecorations = useMemo(
+    () => buildLineDecorations(analysisResult?.violations ?? []),
+    [analysisResult?.violations]
+  );
+
+  // Apply violation highlighting when the decorations or the file change.
+  // Only lines whose decorations differ from what is already applied are
+  // passed to deltaDecorations, so switching between results or streaming
+  // in another batch of violations touches just the changed lines. A new
+  // file replaces the model text, so everything is reapplied.
   useEffect(() => {
-    if (!editorRef.current || !analysisResult || !analysisResult.violations) {
+    if (!editorRef.current) {
       return;
     }
 
-    const editor = editorRef.current;
-    const decorations: editor.IModelDeltaDecoration[] = [];
+    const applied = code === appliedCodeRef.current ? appliedRef.current : new Map<number, AppliedLine>();
+    const removed: string[] = [];
+    const added: editor.IModelDeltaDecoration[] = [];
+    const addedLines: LineDecorations[] = [];
 
-    // Group violations by line number for better handling
-    const violationsByLine = new Map<number, typeof analysisResult.violations>();
-    analysisResult.violations.forEach(violation => {
-      const line = violation.line_number;
-      if (!violationsByLine.has(line)) {
-        violationsByLine.set(line, []);
+    appliedRef.current.forEach((line, lineNumber) => {
+      if (applied !== appliedRef.current || lineDecorations.get(lineNumber)?.key !== line.key) {
+        removed.push(...line.ids);
       }
-      violationsByLine.get(line)!.push(violation);
     });
-
-    // Create decorations for each line with violations
-    violationsByLine.forEach((violations, lineNumber) => {
-      // Find the highest severity for this line
-      const severities = violations.map(v => v.severity);
-      let severity: ViolationSeverity;
-
-      if (severities.includes(ViolationSeverity.CRITICAL)) {
-        severity = ViolationSeverity.CRITICAL;
-      } else if (severities.includes(ViolationSeverity.WARNING)) {
-        severity = ViolationSeverity.WARNING;
-      } else {
-        severity = ViolationSeverity.MINOR;
+    lineDecorations.forEach(line => {
+      if (applied.get(line.lineNumber)?.key !== line.key) {
+        added.push(...line.decorations);
+        addedLines.push(line);
       }
-
-      // Get color based on severity
-      const getBackgroundColor = (sev: ViolationSeverity): string => {
-        switch (sev) {
-          case ViolationSeverity.CRITICAL:
-            return 'rgba(239, 68, 68, 0.15)'; // red with transparency
-          case ViolationSeverity.WARNING:
-            return 'rgba(245, 158, 11, 0.15)'; // amber with transparency
-          case ViolationSeverity.MINOR:
-            return 'rgba(59, 130, 246, 0.15)'; // blue with transparency
-          default:
-            return 'rgba(156, 163, 175, 0.15)'; // gray fallback
-        }
-      };
-
-      const getBorderColor = (sev: ViolationSeverity): string => {
-        switch (sev) {
-          case ViolationSeverity.CRITICAL:
-            return 'rgba(239, 68, 68, 0.6)'; // red
-          case ViolationSeverity.WARNING:
-            return 'rgba(245, 158, 11, 0.6)'; // amber
-          case ViolationSeverity.MINOR:
-            return 'rgba(59, 130, 246, 0.6)'; // blue
-          default:
-            return 'rgba(156, 163, 175, 0.6)'; // gray fallback
-        }
-      };
-
-      // Add line highlight decoration
-      decorations.push({
-        range: {
-          startLineNumber: lineNumber,
-          startColumn: 1,
-          endLineNumber: lineNumber,
-          endColumn: Number.MAX_VALUE,
-        },
-        options: {
-          isWholeLine: true,
-          className: 'violation-line',
-          glyphMarginClassName: 'violation-glyph',
-          glyphMarginHoverMessage: {
-            value: violations.map(v =>
-              `**${v.severity}**: ${v.description}`
-            ).join('\n\n'),
-          },
-          inlineClassName: 'violation-inline',
-          overviewRuler: {
-            color: getBorderColor(severity),
-            position: 4, // OverviewRulerLane.Full
-          },
-          minimap: {
-            color: getBorderColor(severity),
-            position: 2, // MinimapPosition.Inline
-          },
-        },
-      });
-
-      // Add background decoration
-      decorations.push({
-        range: {
-          startLineNumber: lineNumber,
-          startColumn: 1,
-          endLineNumber: lineNumber,
-          endColumn: Number.MAX_VALUE,
-        },
-        options: {
-          isWholeLine: true,
-          className: '',
-          inlineClassName: '',
-          linesDecorationsClassName: `violation-decoration-${severity.toLowerCase()}`,
-        },
-      });
     });
+    if (removed.length === 0 && added.length === 0) {
+      return;
+    }
 
-    // Apply all decorations
-    const decorationIds = editor.deltaDecorations([], decorations);
-
-    // Store decoration IDs for cleanup
-    return () => {
-      if (editor && decorationIds) {
-        editor.deltaDecorations(decorationIds, []);
+    const ids = editorRef.current.deltaDecorations(removed, added);
+    const next = new Map<number, AppliedLine>();
+    applied.forEach((line, lineNumber) => {
+      if (lineDecorations.get(lineNumber)?.key === line.key) {
+        next.set(lineNumber, line);
       }
-    };
-  }, [analysisResult]);
+    });
+    let offset = 0;
+    addedLines.forEach(line => {
+      next.set(line.lineNumber, { key: line.key, ids: ids.slice(offset, offset + line.decorations.length) });
+      offset += line.decorations.length;
+    });
+    appliedRef.current = next;
+    appliedCodeRef.current = code;
+  }, [lineDecorations, code, editorMounts]);
 
   const handleEditorDidMount = (editor: editor.IStandaloneCodeEditor) => {
     editorRef.current = editor;
+    // A fresh editor has no decorations yet
+    appliedRef.current = new Map();
+    appliedCodeRef.current = null;
+    setEditorMounts(n => n + 1);
 
     // Add custom CSS for violation highlighting
     const style = document.createElement('style');
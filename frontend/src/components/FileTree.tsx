@@ -1,9 +1,17 @@
 /**
  * FileTree Component - Display files in a hierarchical tree structure
+ *
+ * The tree is flattened into its visible rows and only the rows inside the
+ * scroll viewport (plus a few either side) are rendered, so a whole course's
+ * submissions stay cheap to scroll and expand.
  */
-import React, { useState } from 'react';
+import React, { useEffect, useMemo, useRef, useState } from 'react';
 import { ChevronRight, ChevronDown, Folder, File, X } from 'lucide-react';
 import { FileTreeNode, UploadedFile } from '../types';
+import { flattenVisibleTree, VisibleTreeRow } from '../utils/fileTreeUtils';
+
+const ROW_HEIGHT = 36; // px; every row has the same height so offsets are index * ROW_HEIGHT
+const OVERSCAN_ROWS = 8;
 
 interface FileTreeProps {
   tree: FileTreeNode[];
@@ -19,6 +27,26 @@ const FileTree: React.FC<FileTreeProps> = ({
   onFileDelete,
 }) => {
   const [expandedFolders, setExpandedFolders] = useState<Set<string>>(new Set());
+  const [scrollTop, setScrollTop] = useState(0);
+  const [viewportHeight, setViewportHeight] = useState(0);
+  const containerRef = useRef<HTMLDivElement>(null);
+
+  const rows = useMemo(() => flattenVisibleTree(tree, expandedFolders), [tree, expandedFolders]);
+
+  // Track the viewport height so the rendered window follows panel resizes
+  useEffect(() => {
+    const container = containerRef.current;
+    if (!container) {
+      return;
+    }
+    setViewportHeight(container.clientHeight);
+    if (typeof ResizeObserver === 'undefined') {
+      return;
+    }
+    const observer = new ResizeObserver(() => setViewportHeight(container.clientHeight));
+    observer.observe(container);
+    return () => observer.disconnect();
+  }, []);
 
   const toggleFolder = (path: string) => {
     setExpandedFolders(prev => {
@@ -32,35 +60,26 @@ const FileTree: React.FC<FileTreeProps> = ({
     });
   };
 
-  const renderNode = (node: FileTreeNode, depth: number = 0): React.ReactNode => {
+  const renderRow = ({ node, depth }: VisibleTreeRow): React.ReactNode => {
     const isExpanded = expandedFolders.has(node.path);
     const isSelected = node.type === 'file' && node.file_id === selectedFile?.file_id;
-    const paddingLeft = depth * 16 + 8;
+    const style = { height: `${ROW_HEIGHT}px`, paddingLeft: `${depth * 16 + 8}px` };
 
     if (node.type === 'folder') {
       return (
-        <div key={node.path}>
-          {/* Folder Node */}
-          <div
-            onClick={() => toggleFolder(node.path)}
-            className="flex items-center gap-2 p-2 cursor-pointer hover:bg-gray-700 transition-colors"
-            style={{ paddingLeft: `${paddingLeft}px` }}
-          >
-            {isExpanded ? (
-              <ChevronDown size={16} className="flex-shrink-0" />
-            ) : (
-              <ChevronRight size={16} className="flex-shrink-0" />
-            )}
-            <Folder size={16} className="flex-shrink-0 text-yellow-500" />
-            <span className="text-sm truncate">{node.name}</span>
-          </div>
-
-          {/* Children (if expanded) */}
-          {isExpanded && node.children && (
-            <div>
-              {node.children.map(child => renderNode(child, depth + 1))}
-            </div>
+        <div
+          key={node.path}
+          onClick={() => toggleFolder(node.path)}
+          className="flex items-center gap-2 pr-2 cursor-pointer hover:bg-gray-700 transition-colors"
+          style={style}
+        >
+          {isExpanded ? (
+            <ChevronDown size={16} className="flex-shrink-0" />
+          ) : (
+            <ChevronRight size={16} className="flex-shrink-0" />
           )}
+          <Folder size={16} className="flex-shrink-0 text-yellow-500" />
+          <span className="text-sm truncate">{node.name}</span>
         </div>
       );
     } else {
@@ -69,10 +88,10 @@ const FileTree: React.FC<FileTreeProps> = ({
         <div
           key={node.path}
           onClick={() => onFileSelect(node)}
-          className={`flex items-center justify-between p-2 cursor-pointer transition-colors ${
+          className={`flex items-center justify-between pr-2 cursor-pointer transition-colors ${
             isSelected ? 'bg-blue-600' : 'hover:bg-gray-700'
           }`}
-          style={{ paddingLeft: `${paddingLeft}px` }}
+          style={style}
         >
           <div className="flex items-center gap-2 flex-1 min-w-0">
             <div style={{ width: '16px' }} /> {/* Spacer for alignment */}
@@ -95,15 +114,28 @@ const FileTree: React.FC<FileTreeProps> = ({
     }
   };
 
+  // Rows in (or near) the viewport; before the first measurement render one screenful
+  const visibleCount = Math.ceil((viewportHeight || window.innerHeight) / ROW_HEIGHT);
+  const first = Math.max(0, Math.floor(scrollTop / ROW_HEIGHT) - OVERSCAN_ROWS);
+  const last = Math.min(rows.length, first + visibleCount + 2 * OVERSCAN_ROWS);
+
   return (
-    <div className="space-y-0.5">
+    <div
+      ref={containerRef}
+      className="h-full overflow-y-auto"
+      onScroll={e => setScrollTop(e.currentTarget.scrollTop)}
+    >
       {tree.length === 0 ? (
         <div className="text-center text-gray-500 mt-8 px-4">
           <p>No files uploaded</p>
           <p className="text-sm mt-1">Upload .cpp, .hpp, or .h files</p>
         </div>
       ) : (
-        tree.map(node => renderNode(node, 0))
+        <div style={{ height: `${rows.length * ROW_HEIGHT}px`, position: 'relative' }}>
+          <div style={{ transform: `translateY(${first * ROW_HEIGHT}px)` }}>
+            {rows.slice(first, last).map(renderRow)}
+          </div>
+        </div>
       )}
     </div>
   );
@@ -83,8 +83,8 @@ const FileUploader: React.FC<FileUploaderProps> = ({
         />
       </div>
 
-      {/* File Tree */}
-      <div className="flex-1 overflow-y-auto">
+      {/* File Tree (scrolls itself so it can window its rows) */}
+      <div className="flex-1 min-h-0">
         <FileTree
           tree={fileTree}
           selectedFile={selectedFile}
@@ -5,6 +5,13 @@ import React from 'react';
 import { AlertCircle, AlertTriangle, Info } from 'lucide-react';
 import { AnalysisResult, Violation, ViolationSeverity } from '../types';
 
+const stageLabels: Record<string, string> = {
+  formatting: 'formatting checks',
+  semantic: 'semantic checks',
+  llm: 'LLM comment review',
+  dedup: 'finalizing',
+};
+
 interface ViolationPanelProps {
   analysisResult: AnalysisResult | null;
 }
@@ -48,6 +55,28 @@ const ViolationPanel: React.FC<ViolationPanelProps> = ({ analysisResult }) => {
       <div className="p-4 border-b border-gray-700">
         <h2 className="text-lg font-semibold mb-3">Analysis Results</h2>
 
+        {analysisResult.streaming && (
+          <div className="text-xs text-blue-400 mb-3">
+            Analyzing{analysisResult.stage ? ` (${stageLabels[analysisResult.stage] || analysisResult.stage})` : ''}…
+            more violations may still arrive
+          </div>
+        )}
+
+        {analysisResult.llm_skipped && (
+          <div className="text-xs text-gray-400 mb-3">
+            LLM review skipped: {analysisResult.llm_skipped}
+          </div>
+        )}
+
+        {analysisResult.omitted_violations && (
+          <div className="text-xs text-gray-400 mb-3">
+            Large file: only the first violations of each type are listed. Not listed:{' '}
+            {Object.entries(analysisResult.omitted_violations)
+              .map(([type, count]) => `${type} (${count})`)
+              .join(', ')}
+          </div>
+        )}
+
         {/* Summary Stats */}
         <div className="bg-gray-700 rounded p-3 mb-3">
           <div className="text-sm text-gray-400 mb-1">Total Violations</div>
@@ -88,7 +117,11 @@ const ViolationPanel: React.FC<ViolationPanelProps> = ({ analysisResult }) => {
 
       {/* Violation List */}
       <div className="flex-1 overflow-y-auto p-4">
-        {analysisResult.violations.length === 0 ? (
+        {analysisResult.violations.length === 0 && analysisResult.streaming ? (
+          <div className="text-center text-gray-500 mt-8">
+            <p className="text-sm">Waiting for results…</p>
+          </div>
+        ) : analysisResult.violations.length === 0 ? (
           <div className="text-center text-green-500 mt-8">
             <p className="text-lg font-semibold">No violations found!</p>
             <p className="text-sm mt-1">Code follows the style guide</p>
@@ -113,10 +146,14 @@ const ViolationPanel: React.FC<ViolationPanelProps> = ({ analysisResult }) => {
                   </div>
                 </div>
                 <p className="text-sm text-gray-300 mb-2">{violation.description}</p>
-                {violation.style_guide_reference && (
+                {violation.style_guide_reference ? (
                   <div className="text-xs text-gray-500 italic">
                     Ref: {violation.style_guide_reference}
                   </div>
+                ) : analysisResult.guide_context?.[violation.type] && (
+                  <div className="text-xs text-gray-500 italic whitespace-pre-line">
+                    Guide: {analysisResult.guide_context[violation.type]}
+                  </div>
                 )}
               </div>
             ))}
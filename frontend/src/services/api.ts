@@ -2,7 +2,7 @@
  * API service for communicating with backend
  */
 import axios from 'axios';
-import { AnalysisResult, UploadedFile, RAGDocument } from '../types';
+import { AnalysisJobStatus, ArchiveUploadResult, AnalysisResult, AnalysisStreamHandlers, BatchAnalysisResult, UploadedFile, RAGDocument } from '../types';
 
 const API_BASE_URL = process.env.REACT_APP_API_URL || 'http://localhost:8000/api';
 
@@ -30,6 +30,44 @@ export const uploadFile = async (file: File, relativePath?: string): Promise<Upl
   return response.data;
 };
 
+export const uploadArchive = async (
+  archive: File,
+  pathPrefix?: string,
+  analyzeWith?: { styleGuideId: string; useRag: boolean }
+): Promise<ArchiveUploadResult> => {
+  const formData = new FormData();
+  formData.append('file', archive);
+  if (pathPrefix) {
+    formData.append('path_prefix', pathPrefix);
+  }
+  if (analyzeWith) {
+    formData.append('analyze', 'true');
+    formData.append('style_guide_id', analyzeWith.styleGuideId);
+    formData.append('use_rag', String(analyzeWith.useRag));
+  }
+
+  const response = await api.post('/files/upload/archive', formData, {
+    headers: {
+      'Content-Type': 'multipart/form-data',
+    },
+  });
+
+  return response.data;
+};
+
+export const uploadFileRevision = async (fileId: string, file: File): Promise<UploadedFile> => {
+  const formData = new FormData();
+  formData.append('file', file);
+
+  const response = await api.put(`/files/${fileId}`, formData, {
+    headers: {
+      'Content-Type': 'multipart/form-data',
+    },
+  });
+
+  return response.data;
+};
+
 export const listFiles = async (): Promise<{ files: UploadedFile[] }> => {
   const response = await api.get('/files/list');
   return response.data;
@@ -58,12 +96,116 @@ export const analyzeCode = async (
   return response.data;
 };
 
+/**
+ * Analyze a file via Server-Sent Events; rule-based violations arrive first,
+ * LLM comment issues as they are generated. Resolves with the final result.
+ */
+export const analyzeCodeStream = async (
+  fileId: string,
+  styleGuideId: string | undefined,
+  useRag: boolean,
+  handlers: AnalysisStreamHandlers
+): Promise<AnalysisResult> => {
+  const response = await fetch(`${API_BASE_URL}/analysis/analyze/stream`, {
+    method: 'POST',
+    headers: { 'Content-Type': 'application/json' },
+    body: JSON.stringify({
+      file_id: fileId,
+      style_guide_id: styleGuideId,
+      use_rag: useRag,
+    }),
+  });
+  if (!response.ok || !response.body) {
+    const body = await response.json().catch(() => null);
+    throw new Error(body?.detail || `Analysis failed (${response.status})`);
+  }
+
+  const reader = response.body.getReader();
+  const decoder = new TextDecoder();
+  let buffer = '';
+  let result: AnalysisResult | null = null;
+
+  const handleEvent = (raw: string) => {
+    let event = 'message';
+    const dataLines: string[] = [];
+    raw.split('\n').forEach(line => {
+      if (line.startsWith('event:')) event = line.slice(6).trim();
+      else if (line.startsWith('data:')) dataLines.push(line.slice(5).trim());
+    });
+    if (dataLines.length === 0) return;
+    const data = JSON.parse(dataLines.join('\n'));
+
+    switch (event) {
+      case 'stage':
+        handlers.onStage?.(data.stage);
+        break;
+      case 'violations':
+        handlers.onViolations?.(data.stage, data.violations, {
+          violations_by_severity: data.violations_by_severity ?? {},
+          violations_by_type: data.violations_by_type ?? {},
+        });
+        break;
+      case 'result':
+        result = data;
+        break;
+      case 'error':
+        throw new Error(data.detail || 'Analysis failed');
+    }
+  };
+
+  while (true) {
+    const { done, value } = await reader.read();
+    if (done) break;
+    buffer += decoder.decode(value, { stream: true });
+    let boundary = buffer.indexOf('\n\n');
+    while (boundary !== -1) {
+      handleEvent(buffer.slice(0, boundary));
+      buffer = buffer.slice(boundary + 2);
+      boundary = buffer.indexOf('\n\n');
+    }
+  }
+
+  if (!result) {
+    throw new Error('Analysis stream ended without a result');
+  }
+  return result;
+};
+
+export const startAnalysis = async (
+  fileId: string,
+  styleGuideId?: string,
+  useRag: boolean = true
+): Promise<AnalysisJobStatus> => {
+  const response = await api.post('/analysis/analyze', {
+    file_id: fileId,
+    style_guide_id: styleGuideId,
+    use_rag: useRag,
+    background: true,
+  });
+  return response.data;
+};
+
+export const analyzeBatch = async (
+  fileIds: string[],
+  styleGuideId?: string,
+  useRag: boolean = true,
+  pathPrefix?: string
+): Promise<BatchAnalysisResult> => {
+  const response = await api.post('/analysis/analyze/batch', {
+    file_ids: fileIds,
+    path_prefix: pathPrefix,
+    style_guide_id: styleGuideId,
+    use_rag: useRag,
+  });
+  return response.data;
+};
+
 export const getAnalysisResults = async (analysisId: string): Promise<AnalysisResult> => {
   const response = await api.get(`/analysis/results/${analysisId}`);
   return response.data;
 };
 
-export const getAnalysisStatus = async (analysisId: string): Promise<any> => {
+export const getAnalysisStatus = async (analysisId: string): Promise<AnalysisJobStatus> => {
   const response = await api.get(`/analysis/status/${analysisId}`);
   return response.data;
 };
@@ -28,6 +28,57 @@ export interface AnalysisResult {
   violations_by_type: Record<string, number>;
   status: string;
   error_message?: string;
+  incremental?: boolean;  // Derived from the previous revision's results
+  cached?: boolean;  // Served from the backend result cache
+  reused_from?: string;  // file_id of the near-duplicate whose analysis was reused
+  similarity?: number;  // Estimated similarity to reused_from, 0.0 - 1.0
+  llm_skipped?: string;  // Why the LLM comment check was not called, e.g. 'no non-header comments'
+  streamed?: boolean;  // Large file analyzed line by line, without parse tree or LLM review
+  omitted_violations?: Record<string, number>;  // Per type, violations counted in the totals but not listed
+  guide_context?: Record<string, string>;  // Per violation type, the style guide excerpt for its rule
+  timings?: Record<string, number>;  // Seconds per stage (requested with include_timings)
+  streaming?: boolean;  // Partial result while /analyze/stream is still running
+  stage?: string;  // Stage currently running while streaming
+}
+
+// Running totals sent by the backend with each streamed batch of violations
+export interface StreamedViolationCounts {
+  violations_by_severity: Record<string, number>;
+  violations_by_type: Record<string, number>;
+}
+
+export interface AnalysisStreamHandlers {
+  onStage?: (stage: string) => void;
+  onViolations?: (stage: string, violations: Violation[], counts: StreamedViolationCounts) => void;
+}
+
+export interface AnalysisJobStatus {
+  analysis_id: string;
+  file_id: string;
+  status: 'queued' | 'running' | 'completed' | 'failed';
+  stage?: string;
+  stages: string[];
+  stages_completed: string[];
+  progress: number;  // 0.0 - 1.0
+  created_at: string;
+  updated_at: string;
+  error_message?: string;
+}
+
+export interface BatchAnalysisSummary {
+  total_files: number;
+  analyzed_files: number;
+  failed_files: number;
+  cached_files: number;
+  reused_files?: number;  // Analyzed incrementally from a near-duplicate in the batch
+  total_violations: number;
+  violations_by_severity: Record<string, number>;
+  violations_by_type: Record<string, number>;
+}
+
+export interface BatchAnalysisResult {
+  results: Record<string, AnalysisResult>;  // keyed by file_id
+  summary: BatchAnalysisSummary;
 }
 
 export interface UploadedFile {
@@ -39,6 +90,12 @@ export interface UploadedFile {
   status: string;
 }
 
+export interface ArchiveUploadResult {
+  files: UploadedFile[];
+  skipped: { path: string; reason: string }[];
+  analysis: BatchAnalysisResult | null;  // set when the upload asked for analysis
+}
+
 // Tree node for hierarchical file display
 export interface FileTreeNode {
   name: string;
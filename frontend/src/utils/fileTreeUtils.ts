@@ -105,6 +105,39 @@ export function buildFileTree(files: UploadedFile[]): FileTreeNode[] {
   return sortNodes(rootNodes);
 }
 
+/**
+ * A tree node as one row of the rendered (windowed) file list
+ */
+export interface VisibleTreeRow {
+  node: FileTreeNode;
+  depth: number;
+}
+
+/**
+ * Flatten the rows currently visible: every root node, plus the children of
+ * expanded folders, in display order
+ */
+export function flattenVisibleTree(tree: FileTreeNode[], expandedFolders: Set<string>): VisibleTreeRow[] {
+  const rows: VisibleTreeRow[] = [];
+  // Explicit stack (pushed in reverse) so deep archives cannot overflow the call stack
+  const stack: VisibleTreeRow[] = [];
+  for (let i = tree.length - 1; i >= 0; i--) {
+    stack.push({ node: tree[i], depth: 0 });
+  }
+
+  while (stack.length > 0) {
+    const row = stack.pop()!;
+    rows.push(row);
+    const { node, depth } = row;
+    if (node.type === 'folder' && node.children && expandedFolders.has(node.path)) {
+      for (let i = node.children.length - 1; i >= 0; i--) {
+        stack.push({ node: node.children[i], depth: depth + 1 });
+      }
+    }
+  }
+  return rows;
+}
+
 /**
  * Find a file in the tree by file_id
  */
@@ -0,0 +1,341 @@
+/**
+ * IndexedDB persistence for uploaded files and analysis results
+ *
+ * Each file and each result is its own record, so saving one result or
+ * deleting one file writes only that record. Results are stored compactly:
+ * violations become columns that index into a per-result string table
+ * (rule types, descriptions and references repeat heavily), and the
+ * encoded record is gzip-compressed with CompressionStream where the
+ * browser has it. All reads and writes are asynchronous, so loading a whole
+ * graded class does not block the main thread.
+ */
+
+import { UploadedFile, AnalysisResult, Violation, ViolationSeverity } from '../types';
+
+const DB_NAME = 'code-grader';
+const DB_VERSION = 1;
+const STORES = {
+  FILES: 'files',
+  RESULTS: 'results',
+};
+
+interface StoredFile {
+  file_id: string;
+  seq: number;  // upload order
+  file: UploadedFile;
+}
+
+interface StoredResult {
+  file_id: string;
+  encoding: 'gzip' | 'json';
+  data: Blob | string;
+}
+
+// Violations as parallel columns; string columns hold indexes into `strings` (-1 = absent)
+interface EncodedViolations {
+  strings: string[];
+  type: number[];
+  severity: number[];
+  line_number: number[];
+  column: (number | null)[];
+  description: number[];
+  style_guide_reference: number[];
+  code_snippet: number[];
+}
+
+interface EncodedResult {
+  result: Omit<AnalysisResult, 'violations'>;
+  violations: EncodedViolations;
+}
+
+const SEVERITIES = [ViolationSeverity.CRITICAL, ViolationSeverity.WARNING, ViolationSeverity.MINOR];
+
+let dbPromise: Promise<IDBDatabase> | null = null;
+const fileSeqs = new Map<string, number>();
+let nextSeq = 0;
+// Writes run one after another so an older save can never land after a newer one
+let writeQueue: Promise<void> = Promise.resolve();
+
+const enqueueWrite = (write: () => Promise<void>): Promise<void> => {
+  writeQueue = writeQueue.then(write, write);
+  return writeQueue;
+};
+
+/**
+ * Whether IndexedDB exists in this environment (not in some test runners)
+ */
+export const isIndexedDbAvailable = (): boolean => typeof indexedDB !== 'undefined';
+
+const openDb = (): Promise<IDBDatabase> => {
+  if (!dbPromise) {
+    dbPromise = new Promise((resolve, reject) => {
+      if (!isIndexedDbAvailable()) {
+        reject(new Error('IndexedDB is not available'));
+        return;
+      }
+      const request = indexedDB.open(DB_NAME, DB_VERSION);
+      request.onupgradeneeded = () => {
+        const db = request.result;
+        if (!db.objectStoreNames.contains(STORES.FILES)) {
+          db.createObjectStore(STORES.FILES, { keyPath: 'file_id' });
+        }
+        if (!db.objectStoreNames.contains(STORES.RESULTS)) {
+          db.createObjectStore(STORES.RESULTS, { keyPath: 'file_id' });
+        }
+      };
+      request.onsuccess = () => resolve(request.result);
+      request.onerror = () => reject(request.error);
+    });
+    // Let a later call retry if opening failed
+    dbPromise.catch(() => {
+      dbPromise = null;
+    });
+  }
+  return dbPromise;
+};
+
+const requestResult = <T>(request: IDBRequest<T>): Promise<T> =>
+  new Promise((resolve, reject) => {
+    request.onsuccess = () => resolve(request.result);
+    request.onerror = () => reject(request.error);
+  });
+
+const transactionDone = (tx: IDBTransaction): Promise<void> =>
+  new Promise((resolve, reject) => {
+    tx.oncomplete = () => resolve();
+    tx.onerror = () => reject(tx.error);
+    tx.onabort = () => reject(tx.error);
+  });
+
+const fileId = (file: UploadedFile): string => (file as any).id || file.file_id;
+
+// --- Result encoding ---
+
+const encodeViolations = (violations: Violation[]): EncodedViolations => {
+  const strings: string[] = [];
+  const indexes = new Map<string, number>();
+  const intern = (value: string | null | undefined): number => {
+    if (value === null || value === undefined) {
+      return -1;
+    }
+    let index = indexes.get(value);
+    if (index === undefined) {
+      index = strings.length;
+      strings.push(value);
+      indexes.set(value, index);
+    }
+    return index;
+  };
+
+  const encoded: EncodedViolations = {
+    strings,
+    type: [],
+    severity: [],
+    line_number: [],
+    column: [],
+    description: [],
+    style_guide_reference: [],
+    code_snippet: [],
+  };
+  violations.forEach(v => {
+    encoded.type.push(intern(v.type));
+    encoded.severity.push(SEVERITIES.indexOf(v.severity));
+    encoded.line_number.push(v.line_number);
+    encoded.column.push(v.column ?? null);
+    encoded.description.push(intern(v.description));
+    encoded.style_guide_reference.push(intern(v.style_guide_reference));
+    encoded.code_snippet.push(intern(v.code_snippet));
+  });
+  return encoded;
+};
+
+const decodeViolations = (encoded: EncodedViolations): Violation[] => {
+  const str = (index: number): string | undefined => (index < 0 ? undefined : encoded.strings[index]);
+  return encoded.line_number.map((line_number, i) => {
+    const violation: Violation = {
+      type: str(encoded.type[i]) ?? 'general',
+      severity: SEVERITIES[encoded.severity[i]] ?? ViolationSeverity.MINOR,
+      line_number,
+      description: str(encoded.description[i]) ?? '',
+    };
+    const column = encoded.column[i];
+    if (column !== null) violation.column = column;
+    const reference = str(encoded.style_guide_reference[i]);
+    if (reference !== undefined) violation.style_guide_reference = reference;
+    const snippet = str(encoded.code_snippet[i]);
+    if (snippet !== undefined) violation.code_snippet = snippet;
+    return violation;
+  });
+};
+
+// Declared locally: the DOM typings of the TypeScript version in use predate these streams
+type GzipStream = new (format: 'gzip') => TransformStream<Uint8Array, Uint8Array>;
+const { CompressionStream, DecompressionStream } = globalThis as unknown as {
+  CompressionStream?: GzipStream;
+  DecompressionStream?: GzipStream;
+};
+
+const canCompress = (): boolean =>
+  CompressionStream !== undefined && DecompressionStream !== undefined && typeof Blob !== 'undefined';
+
+const encodeResult = async (id: string, result: AnalysisResult): Promise<StoredResult> => {
+  const { violations, ...rest } = result;
+  const json = JSON.stringify({ result: rest, violations: encodeViolations(violations) } as EncodedResult);
+  if (!canCompress()) {
+    return { file_id: id, encoding: 'json', data: json };
+  }
+  const stream = new Blob([json]).stream().pipeThrough(new CompressionStream!('gzip'));
+  return { file_id: id, encoding: 'gzip', data: await new Response(stream).blob() };
+};
+
+const decodeResult = async (stored: StoredResult): Promise<AnalysisResult> => {
+  let json: string;
+  if (stored.encoding === 'gzip') {
+    if (!DecompressionStream) {
+      throw new Error('Stored result is compressed but DecompressionStream is unavailable');
+    }
+    const stream = (stored.data as Blob).stream().pipeThrough(new DecompressionStream('gzip'));
+    json = await new Response(stream).text();
+  } else {
+    json = stored.data as string;
+  }
+  const encoded: EncodedResult = JSON.parse(json);
+  return { ...encoded.result, violations: decodeViolations(encoded.violations) };
+};
+
+// --- Files ---
+
+/**
+ * Load uploaded files in upload order
+ */
+export const loadStoredFiles = async (): Promise<UploadedFile[]> => {
+  try {
+    const db = await openDb();
+    const records: StoredFile[] = await requestResult(
+      db.transaction(STORES.FILES, 'readonly').objectStore(STORES.FILES).getAll()
+    );
+    records.sort((a, b) => a.seq - b.seq);
+    records.forEach(r => fileSeqs.set(r.file_id, r.seq));
+    nextSeq = records.length > 0 ? records[records.length - 1].seq + 1 : 0;
+    return records.map(r => r.file);
+  } catch (error) {
+    console.error('Error loading uploaded files:', error);
+    return [];
+  }
+};
+
+/**
+ * Write added or changed files and delete removed ones, in one transaction
+ */
+export const saveStoredFiles = (changed: UploadedFile[], removedIds: string[]): Promise<void> => {
+  if (changed.length === 0 && removedIds.length === 0) {
+    return Promise.resolve();
+  }
+  return enqueueWrite(async () => {
+    try {
+      const db = await openDb();
+      const tx = db.transaction(STORES.FILES, 'readwrite');
+      const store = tx.objectStore(STORES.FILES);
+      removedIds.forEach(id => {
+        store.delete(id);
+        fileSeqs.delete(id);
+      });
+      changed.forEach(file => {
+        const id = fileId(file);
+        // Keep the original upload position when a file is rewritten
+        let seq = fileSeqs.get(id);
+        if (seq === undefined) {
+          seq = nextSeq++;
+          fileSeqs.set(id, seq);
+        }
+        store.put({ file_id: id, seq, file } as StoredFile);
+      });
+      await transactionDone(tx);
+    } catch (error) {
+      console.error('Error saving uploaded files:', error);
+    }
+  });
+};
+
+// --- Analysis results ---
+
+/**
+ * Load all analysis results mapped by file ID
+ */
+export const loadStoredResults = async (): Promise<Record<string, AnalysisResult>> => {
+  const results: Record<string, AnalysisResult> = {};
+  try {
+    const db = await openDb();
+    const records: StoredResult[] = await requestResult(
+      db.transaction(STORES.RESULTS, 'readonly').objectStore(STORES.RESULTS).getAll()
+    );
+    for (const record of records) {
+      try {
+        results[record.file_id] = await decodeResult(record);
+      } catch (error) {
+        console.error(`Error decoding analysis result for ${record.file_id}:`, error);
+      }
+    }
+  } catch (error) {
+    console.error('Error loading analysis results:', error);
+  }
+  return results;
+};
+
+/**
+ * Write added or changed results and delete removed ones
+ *
+ * Records are encoded before the transaction opens: IndexedDB transactions
+ * commit as soon as they are idle, so they cannot wait on compression.
+ */
+export const saveStoredResults = (
+  changed: Record<string, AnalysisResult>,
+  removedIds: string[]
+): Promise<void> => {
+  const ids = Object.keys(changed);
+  if (ids.length === 0 && removedIds.length === 0) {
+    return Promise.resolve();
+  }
+  return enqueueWrite(async () => {
+    try {
+      const records = await Promise.all(ids.map(id => encodeResult(id, changed[id])));
+      const db = await openDb();
+      const tx = db.transaction(STORES.RESULTS, 'readwrite');
+      const store = tx.objectStore(STORES.RESULTS);
+      removedIds.forEach(id => store.delete(id));
+      records.forEach(record => store.put(record));
+      await transactionDone(tx);
+    } catch (error) {
+      console.error('Error saving analysis results:', error);
+    }
+  });
+};
+
+/**
+ * Save the analysis result for a single file
+ */
+export const saveStoredResult = (id: string, result: AnalysisResult): Promise<void> =>
+  saveStoredResults({ [id]: result }, []);
+
+/**
+ * Delete the analysis result for a single file
+ */
+export const deleteStoredResult = (id: string): Promise<void> => saveStoredResults({}, [id]);
+
+/**
+ * Clear all stored files and results
+ */
+export const clearStoredData = (): Promise<void> =>
+  enqueueWrite(async () => {
+    try {
+      const db = await openDb();
+      const tx = db.transaction([STORES.FILES, STORES.RESULTS], 'readwrite');
+      tx.objectStore(STORES.FILES).clear();
+      tx.objectStore(STORES.RESULTS).clear();
+      await transactionDone(tx);
+      fileSeqs.clear();
+      nextSeq = 0;
+    } catch (error) {
+      console.error('Error clearing stored data:', error);
+    }
+  });
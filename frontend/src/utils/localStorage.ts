@@ -1,9 +1,12 @@
 /**
- * Utility functions for persisting data to sessionStorage
+ * Utility functions for persisting small UI state to sessionStorage
  * SessionStorage persists across page refreshes but is cleared when the browser tab/window is closed
+ *
+ * Uploaded files and analysis results are kept in IndexedDB instead (indexedDbStore.ts)
  */
 
 import { UploadedFile, AnalysisResult } from '../types';
+import { clearStoredData } from './indexedDbStore';
 
 const KEYS = {
   UPLOADED_FILES: 'code-grader-uploaded-files',
@@ -12,91 +15,27 @@ const KEYS = {
 };
 
 /**
- * Save uploaded files to sessionStorage
+ * Read and remove the files and results older versions kept in sessionStorage
+ *
+ * They now live in IndexedDB (see indexedDbStore.ts); this lets the app
+ * move them over once.
  */
-export const saveUploadedFiles = (files: UploadedFile[]): void => {
+export const takeLegacyPersistedData = (): {
+  files: UploadedFile[];
+  results: Record<string, AnalysisResult>;
+} => {
   try {
-    sessionStorage.setItem(KEYS.UPLOADED_FILES, JSON.stringify(files));
-  } catch (error) {
-    console.error('Error saving uploaded files:', error);
-  }
-};
-
-/**
- * Load uploaded files from sessionStorage
- */
-export const loadUploadedFiles = (): UploadedFile[] => {
-  try {
-    const data = sessionStorage.getItem(KEYS.UPLOADED_FILES);
-    if (!data) return [];
-    return JSON.parse(data);
-  } catch (error) {
-    console.error('Error loading uploaded files:', error);
-    return [];
-  }
-};
-
-/**
- * Save analysis results mapped by file ID
- */
-export const saveAnalysisResults = (results: Record<string, AnalysisResult>): void => {
-  try {
-    sessionStorage.setItem(KEYS.ANALYSIS_RESULTS, JSON.stringify(results));
-  } catch (error) {
-    console.error('Error saving analysis results:', error);
-  }
-};
-
-/**
- * Load all analysis results
- */
-export const loadAnalysisResults = (): Record<string, AnalysisResult> => {
-  try {
-    const data = sessionStorage.getItem(KEYS.ANALYSIS_RESULTS);
-    if (!data) return {};
-    return JSON.parse(data);
-  } catch (error) {
-    console.error('Error loading analysis results:', error);
-    return {};
-  }
-};
-
-/**
- * Save analysis result for a specific file
- */
-export const saveAnalysisResult = (fileId: string, result: AnalysisResult): void => {
-  try {
-    const allResults = loadAnalysisResults();
-    allResults[fileId] = result;
-    saveAnalysisResults(allResults);
-  } catch (error) {
-    console.error('Error saving analysis result:', error);
-  }
-};
-
-/**
- * Get analysis result for a specific file
- */
-export const getAnalysisResult = (fileId: string): AnalysisResult | null => {
-  try {
-    const allResults = loadAnalysisResults();
-    return allResults[fileId] || null;
-  } catch (error) {
-    console.error('Error getting analysis result:', error);
-    return null;
-  }
-};
-
-/**
- * Delete analysis result for a specific file
- */
-export const deleteAnalysisResult = (fileId: string): void => {
-  try {
-    const allResults = loadAnalysisResults();
-    delete allResults[fileId];
-    saveAnalysisResults(allResults);
+    const files = sessionStorage.getItem(KEYS.UPLOADED_FILES);
+    const results = sessionStorage.getItem(KEYS.ANALYSIS_RESULTS);
+    sessionStorage.removeItem(KEYS.UPLOADED_FILES);
+    sessionStorage.removeItem(KEYS.ANALYSIS_RESULTS);
+    return {
+      files: files ? JSON.parse(files) : [],
+      results: results ? JSON.parse(results) : {},
+    };
   } catch (error) {
-    console.error('Error deleting analysis result:', error);
+    console.error('Error loading legacy persisted data:', error);
+    return { files: [], results: {} };
   }
 };
 
@@ -131,6 +70,7 @@ export const loadSelectedFileId = (): string | null => {
  * Clear all persisted data
  */
 export const clearAllPersistedData = (): void => {
+  clearStoredData();
   try {
     sessionStorage.removeItem(KEYS.UPLOADED_FILES);
     sessionStorage.removeItem(KEYS.ANALYSIS_RESULTS);